@@ -1,5 +1,8 @@
 #!/bin/bash
 
+# Pin the size where af switches to FFT, so outputs do not depend on timing
+export FFT_CROSSOVER=65
+
 function init {
     total_score=0
     task7_score=0
@@ -163,7 +166,7 @@ function run_checker {
 	check_homework task4 1 5 # 1 pct, 5 tests
 	check_homework task5 1 5 # 1 pct, 5 tests
 	check_homework task6 3 5 # 3 pct, 5 tests
-	check_homework task7 2 15 # 3 pct, 15 tests
+	check_homework task7 2 22 # 3 pct, 22 tests
     check_valgrind 2 3 13 # 2 pct, 10 tests, skip first 3
     check_readme 10 # 10 pct
     check_style
@@ -3,7 +3,65 @@
 #ifndef BMP_H_INCLUDED
 #define BMP_H_INCLUDED
 
-void read_from_bmp(int ***pixel_matrix, int N, int M, const char *path);
-void write_to_bmp(int ***pixel_matrix, int N, int M, const char *path);
+#include <stdio.h>
+
+#define BMP_WRITE_BUFFER (1 << 20)  // rows are batched into writes of this size
+#define BMP_BUFFER_ALIGN 4096       // page aligned write buffer
+
+// Durability policy applied when a saved BMP is closed
+typedef enum {
+    BMP_SYNC_NONE,  // leave the data in the page cache
+    BMP_SYNC_DATA   // fdatasync before closing
+} BmpSync;
+
+#define BMP_HEADER_SIZE 54          // file header + BITMAPINFOHEADER
+#define BMP_DIB_SIZE 40             // smallest supported info header
+#define BMP_MAX_DIMENSION 32768     // rows / columns accepted when reading
+#define BMP_MAX_PIXELS (1L << 26)   // pixels accepted when reading
+
+typedef enum {
+    BMP_OK = 0,
+    BMP_ERR_OPEN = -1,          // file cannot be opened
+    BMP_ERR_HEADER = -2,        // truncated header or not a BMP
+    BMP_ERR_FORMAT = -3,        // not uncompressed 24-bit bottom-up
+    BMP_ERR_DIMENSIONS = -4,    // out of bounds, or width not the one requested
+    BMP_ERR_TRUNCATED = -5,     // file shorter than its pixel data
+    BMP_ERR_MEMORY = -6
+} BmpStatus;
+
+// Validated header fields
+typedef struct TBmpInfo {
+    int width, height;
+    long stride;        // bytes per stored row, padding included
+    long data_offset;   // start of the pixel data
+} BmpInfo;
+
+const char *bmp_strerror(BmpStatus status);
+
+// Validate header, bounds and file length (nothing is allocated)
+BmpStatus bmp_read_info(FILE *file, BmpInfo *info);
+BmpStatus bmp_check_size(int N, int M);
+
+// Open and validate a BMP read as N x M; on success the caller closes file
+BmpStatus bmp_open(const char *path, int N, int M, FILE **file, BmpInfo *info);
+
+/*
+ * Readers decode N x M pixels from a file checked by bmp_open (or
+ * bmp_read_info); M must match the stored width. Rows past the stored
+ * height repeat the last stored pixel.
+ */
+BmpStatus read_from_bmp_stream(FILE *file, const BmpInfo *info, int ***pixel_matrix, int N, int M);
+BmpStatus read_from_bmp(int ***pixel_matrix, int N, int M, const char *path);
+
+// Read only the h x w window at (x, y) of an N x M BMP (crop on load)
+BmpStatus read_from_bmp_window_stream(FILE *file, const BmpInfo *info, int ***pixel_matrix,
+                                      int N, int M, int x, int y, int h, int w);
+
+// Read into three N x M planes (R, then G, then B) stored back to back
+BmpStatus read_from_bmp_planar_stream(FILE *file, const BmpInfo *info, unsigned char *planes, int N, int M);
+
+// Returns 0 on success, -1 if the file could not be fully written
+int write_to_bmp(int ***pixel_matrix, int N, int M, const char *path, BmpSync sync);
+int write_to_bmp_planar(const unsigned char *planes, int N, int M, const char *path, BmpSync sync);
 
 #endif  // BMP_H_INCLUDED
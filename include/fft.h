@@ -0,0 +1,60 @@
+#pragma once
+
+#ifndef FFT_H
+#define FFT_H
+
+#define FFT_MIN_SIZE 64     // smallest FFT used for one convolution tile
+
+typedef struct TComplex {
+    double re, im;
+} Complex;
+
+// Precomputed twiddles and bit-reversal order of a radix-2 FFT
+typedef struct TFftPlan {
+    int n;              // transform length (power of two)
+    Complex *twiddle;   // e^(-2*pi*i*k/n), k < n/2
+    int *reverse;       // bit-reversed index of each position
+} FftPlan;
+
+/**
+ * @brief Prepare a radix-2 FFT of length n.
+ *
+ * @param n Transform length, must be a power of two.
+ * @return Pointer to the plan, NULL if allocation fails.
+ */
+FftPlan *fft_plan(int n);
+
+/**
+ * @brief Free memory allocated for the plan.
+ *
+ * @param plan Pointer to the plan.
+ */
+void fft_free(FftPlan *plan);
+
+/**
+ * @brief In-place FFT of plan->n values.
+ *
+ * @param plan Plan of the transform.
+ * @param data Values to transform.
+ * @param inverse Non-zero for the (unscaled) inverse transform.
+ */
+void fft(const FftPlan *plan, Complex *data, int inverse);
+
+/**
+ * @brief Apply a filter using overlap-add FFT convolution.
+ *
+ * Same zero-border and clamp semantics as apply_filter for odd filter
+ * sizes; each channel value matches the direct sum within +/-1 (the sums
+ * are computed in double precision instead of float before truncation).
+ *
+ * @param image Pointer to the image.
+ * @param N Number of rows.
+ * @param M Number of columns.
+ * @param filter 2D array representing the filter kernel.
+ * @param filter_size Size of the filter kernel (odd).
+ * @return Pointer to the filtered image.
+ */
+int ***apply_filter_fft(int ***image, int N, int M,
+                        float **filter, int filter_size);
+
+#endif  // FFT_H
@@ -4,6 +4,49 @@
 #define IMAGEPROCESSING_H
 
 #define MAX_PIXEL_VALUE 255
+#define HISTOGRAM_BINS 256
+
+#define PLANE_ALIGN 64                  // alignment of planar images
+
+#define MAX_THREADS 16                  // upper bound of row bands per operation
+#define PARALLEL_MIN_PIXELS (1 << 16)   // smaller images run on one thread
+
+// Odd filter sizes for which apply_filter may switch to FFT convolution;
+// the crossover is measured once on a small image, unless it is pinned with
+// -DFFT_CROSSOVER=size or the FFT_CROSSOVER environment variable
+#define FFT_MIN_CROSSOVER 9
+#define FFT_MAX_CROSSOVER 65
+#define FFT_CALIBRATION_SIZE 128
+#define FFT_CALIBRATION_RUNS 7          // best of this many timings per path
+#define FFT_CALIBRATION_MARGIN 1.5      // FFT must be this much faster to win
+
+#define RANK_MAX_SIZE 1023              // largest window of the rank filters
+
+typedef struct TChannelStats {
+    int min, max;   // smallest and largest value present
+    double mean;    // average value
+} ChannelStats;
+
+/**
+ * @brief Clamp a value to the range [min, max].
+ * 
+ * @param value Value to clamp.
+ * @param min Lower bound.
+ * @param max Upper bound.
+ * @return The closest value inside the range.
+ */
+int clamp(int value, int min, int max);
+
+/**
+ * @brief Mark the start of an operation that may run next to others.
+ * 
+ * Operations split rows over threads; while several have started and not
+ * finished, each one only gets its share of the CPUs.
+ */
+void parallel_enter(void);
+
+/** @brief Mark the end of an operation started with parallel_enter. */
+void parallel_leave(void);
 
 /**
  * @brief Allocate memory for a new image.
@@ -98,9 +141,20 @@ int ***extend(int ***image, int N, int M,
 int ***paste(int ***image_dst, int N_dst, int M_dst,
              int ***image_src, int N_src, int M_src, int x, int y);
 
+/**
+ * @brief Measure (or read the pinned) filter size where FFT convolution takes over.
+ * 
+ * Runs once per process; apply_filter calls it when needed, but calling it
+ * before starting other threads keeps the timings free of their noise.
+ */
+void calibrate_fft_crossover(void);
+
 /**
  * @brief Apply a filter to the image.
  * 
+ * Odd filters at least as large as the measured crossover size are
+ * applied with FFT convolution (see apply_filter_fft in fft.h).
+ * 
  * @param image Pointer to the image.
  * @param N Number of rows.
  * @param M Number of columns.
@@ -111,4 +165,161 @@ int ***paste(int ***image_dst, int N_dst, int M_dst,
 int ***apply_filter(int ***image, int N, int M,
                     float **filter, int filter_size);
 
+/**
+ * @brief Count the values of each channel in a single pass over the image.
+ * 
+ * @param image Pointer to the image.
+ * @param N Number of rows.
+ * @param M Number of columns.
+ * @param histogram Per-channel (R, G, B) counts of each value.
+ */
+void compute_histogram(int ***image, int N, int M, unsigned long histogram[3][HISTOGRAM_BINS]);
+
+/**
+ * @brief Derive min, max and mean of each channel from its histogram.
+ * 
+ * @param histogram Per-channel histogram.
+ * @param stats Per-channel (R, G, B) statistics.
+ */
+void compute_stats(unsigned long histogram[3][HISTOGRAM_BINS], ChannelStats stats[3]);
+
+/**
+ * @brief Replace each channel value by its entry in a lookup table (in place).
+ * 
+ * @param image Pointer to the image.
+ * @param N Number of rows.
+ * @param M Number of columns.
+ * @param lut Per-channel (R, G, B) lookup tables.
+ * @return Pointer to the same image.
+ */
+int ***apply_lut(int ***image, int N, int M, unsigned char lut[3][HISTOGRAM_BINS]);
+
+/**
+ * @brief Build a gamma correction table: 255 * (v / 255)^(1 / gamma).
+ * 
+ * @param gamma Gamma value (greater than 0).
+ * @param lut Per-channel lookup tables to fill.
+ */
+void gamma_lut(float gamma, unsigned char lut[3][HISTOGRAM_BINS]);
+
+/**
+ * @brief Build a levels table mapping [low, high] linearly onto [0, 255].
+ * 
+ * @param low Input value mapped to 0.
+ * @param high Input value mapped to 255.
+ * @param lut Per-channel lookup tables to fill.
+ */
+void levels_lut(int low, int high, unsigned char lut[3][HISTOGRAM_BINS]);
+
+/**
+ * @brief Build a per-channel auto-contrast table stretching [min, max] to [0, 255].
+ * 
+ * @param histogram Per-channel histogram of the image.
+ * @param lut Per-channel lookup tables to fill.
+ */
+void autocontrast_lut(unsigned long histogram[3][HISTOGRAM_BINS], unsigned char lut[3][HISTOGRAM_BINS]);
+
+/**
+ * @brief Apply a rank (median, min, max, ...) filter to the image.
+ * 
+ * Each channel value becomes the rank-th smallest of the size x size values
+ * around it; like apply_filter, values outside the image count as 0.
+ * 
+ * @param image Pointer to the image.
+ * @param N Number of rows.
+ * @param M Number of columns.
+ * @param size Window size (odd, at most RANK_MAX_SIZE).
+ * @param rank Position in the sorted window, from 0 (min) to size * size - 1 (max).
+ * @return Pointer to the filtered image.
+ */
+int ***rank_filter(int ***image, int N, int M, int size, int rank);
+
+/*
+ * Planar images keep three N x M planes of 8-bit values back to back
+ * (all R, then all G, then all B) in one block released with free().
+ */
+
+/**
+ * @brief Allocate memory for a new planar image.
+ * 
+ * @param N Number of rows.
+ * @param M Number of columns.
+ * @return Pointer to the R plane, followed by the G and B planes.
+ */
+unsigned char *allocate_planes(int N, int M);
+
+/**
+ * @brief Convert an interleaved image to a new planar image.
+ * 
+ * @param image Pointer to the image.
+ * @param N Number of rows.
+ * @param M Number of columns.
+ * @return Pointer to the planar image.
+ */
+unsigned char *to_planar(int ***image, int N, int M);
+
+/**
+ * @brief Convert a planar image to a new interleaved image.
+ * 
+ * @param planes Pointer to the planar image.
+ * @param N Number of rows.
+ * @param M Number of columns.
+ * @return Pointer to the interleaved image.
+ */
+int ***to_interleaved(const unsigned char *planes, int N, int M);
+
+/**
+ * @brief Apply a filter to a planar image, one channel plane at a time.
+ * 
+ * Same result as apply_filter on the interleaved image.
+ * 
+ * @param planes Pointer to the planar image.
+ * @param N Number of rows.
+ * @param M Number of columns.
+ * @param filter 2D array representing the filter kernel.
+ * @param filter_size Size of the filter kernel.
+ * @return Pointer to the filtered planar image.
+ */
+unsigned char *apply_filter_planar(const unsigned char *planes, int N, int M,
+                                   float **filter, int filter_size);
+
+/**
+ * @brief Count the values of each channel plane of a planar image.
+ * 
+ * @param planes Pointer to the planar image.
+ * @param N Number of rows.
+ * @param M Number of columns.
+ * @param histogram Per-channel (R, G, B) counts of each value.
+ */
+void compute_histogram_planar(const unsigned char *planes, int N, int M,
+                              unsigned long histogram[3][HISTOGRAM_BINS]);
+
+/**
+ * @brief Apply per-channel lookup tables to a planar image (in place).
+ * 
+ * @param planes Pointer to the planar image.
+ * @param N Number of rows.
+ * @param M Number of columns.
+ * @param lut Per-channel (R, G, B) lookup tables.
+ * @return Pointer to the same planar image.
+ */
+unsigned char *apply_lut_planar(unsigned char *planes, int N, int M,
+                                unsigned char lut[3][HISTOGRAM_BINS]);
+
+/**
+ * @brief Apply a rank filter to a planar image, one channel plane at a time.
+ * 
+ * Sliding-window histograms (Perreault-Hebert) keep the cost per value
+ * independent of the window size. Same result as rank_filter.
+ * 
+ * @param planes Pointer to the planar image.
+ * @param N Number of rows.
+ * @param M Number of columns.
+ * @param size Window size (odd, at most RANK_MAX_SIZE).
+ * @param rank Position in the sorted window, from 0 (min) to size * size - 1 (max).
+ * @return Pointer to the filtered planar image.
+ */
+unsigned char *rank_filter_planar(const unsigned char *planes, int N, int M,
+                                  int size, int rank);
+
 #endif  // IMAGEPROCESSING_H
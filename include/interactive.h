@@ -8,17 +8,31 @@
 #include <string.h>
 #include <stdbool.h>
 
+#include <unistd.h>
+
 #include "imageprocessing.h"
 #include "bmp.h"
+#include "scheduler.h"
 
 #define CMD_LENGTH 10
 #define MAX_IMAGES 100
 #define MAX_FILTERS 100
 #define PATH_LENGTH 100
+#define MAX_ARGS 8
+#define MAX_ACCESSES 4
+#define FILE_SLOTS 64   // files are tracked by a hash of their name
+
+// Scheduler resources : images, filters, files and stdout
+#define RESOURCE_IMAGE(i) (i)
+#define RESOURCE_FILTER(i) (MAX_IMAGES + (i))
+#define RESOURCE_FILE(h) (MAX_IMAGES + MAX_FILTERS + (h))
+#define RESOURCE_CONSOLE (MAX_IMAGES + MAX_FILTERS + FILE_SLOTS)
+#define RESOURCE_COUNT (RESOURCE_CONSOLE + 1)
 
 typedef struct TImage {
-    int ***data;    // image data RGB format
-    int N, M;       // (height and width)
+    int ***data;            // image data RGB format
+    unsigned char *planes;  // R, G, B planes instead of data (NULL if interleaved)
+    int N, M;               // (height and width)
 } Image;
 
 typedef struct TFilter {
@@ -34,65 +48,158 @@ typedef struct TImagesFilters {
     int filter_count;
 } ImagesFilters;
 
-typedef void (*CommandFunc)(ImagesFilters*);
+typedef struct TCommand Command;
+
+typedef void (*CommandFunc)(ImagesFilters*, const Command*);
+
+/*
+ * Argument spec of a command, one character per argument in input order:
+ *   n  integer                        v  float
+ *   i  image index (read)             I  image index (written)
+ *   f  filter index (read)            k  filter size followed by its values
+ *   p  path (read)                    P  path (written)
+ *   u  768 lookup table values        c  prints to stdout (no input)
+ *   L  new image slot (no input)      F  new filter slot (no input)
+ *   D  image to delete                E  filter to delete
+ * Integers, indexes and slots go to args in order; D and E are followed
+ * there by the image / filter count before the deletion.
+ */
 
 // Hashmap command-functions
-typedef struct {
+typedef struct TCommandMap {
     char cmd[CMD_LENGTH];   // Command string
+    const char *args;       // Argument spec
     CommandFunc func;       // Pointer function
 } CommandMap;
 
+// A parsed command, run by the scheduler
+struct TCommand {
+    const CommandMap *map;
+    ImagesFilters *images_filters;
+    int args[MAX_ARGS];                     // integer arguments
+    float values[MAX_ARGS];                 // float arguments
+    char path[PATH_LENGTH];                 // file argument
+    float **filter;                         // filter read by cf
+    int filter_size;
+    unsigned char (*lut)[HISTOGRAM_BINS];   // tables read by lu
+    Access accesses[MAX_ACCESSES];          // what the command reads / writes
+    int access_count;
+};
+
 /** @brief Load an image from a file and store it in memory. */
-void Load_image(ImagesFilters *images_filters);
+void Load_image(ImagesFilters *images_filters, const Command *command);
+
+/** @brief Load only a cropped region of an image from a file. */
+void Load_image_crop(ImagesFilters *images_filters, const Command *command);
+
+/** @brief Load an image from a file in the planar (one plane per channel) layout. */
+void Load_image_planar(ImagesFilters *images_filters, const Command *command);
+
+/** @brief Switch an image to the planar layout. */
+void Convert_planar(ImagesFilters *images_filters, const Command *command);
+
+/** @brief Switch an image back to the interleaved layout. */
+void Convert_interleaved(ImagesFilters *images_filters, const Command *command);
 
 /** @brief Save an image to a file. */
-void Save_image(ImagesFilters *images_filters);
+void Save_image(ImagesFilters *images_filters, const Command *command);
+
+/** @brief Save an image to a file and flush it to disk before returning. */
+void Save_image_sync(ImagesFilters *images_filters, const Command *command);
 
 /** @brief Delete an image from memory. */
-void Delete_Image(ImagesFilters *images_filters);
+void Delete_Image(ImagesFilters *images_filters, const Command *command);
 
 /** @brief Apply horizontal flip to an image. */
-void Apply_horizontal_flip(ImagesFilters *images_filters);
+void Apply_horizontal_flip(ImagesFilters *images_filters, const Command *command);
 
 /** @brief Rotate left an image. */
-void Apply_rotate(ImagesFilters *images_filters);
+void Apply_rotate(ImagesFilters *images_filters, const Command *command);
 
 /** @brief Crop an image to a specified region. */
-void Apply_crop(ImagesFilters *images_filters);
+void Apply_crop(ImagesFilters *images_filters, const Command *command);
 
 /** @brief Extend an image by adding a border around it. */
-void Apply_extend(ImagesFilters *images_filters);
+void Apply_extend(ImagesFilters *images_filters, const Command *command);
 
 /** @brief Paste one image onto another image at a specified location. */
-void Apply_paste(ImagesFilters *images_filters);
+void Apply_paste(ImagesFilters *images_filters, const Command *command);
 
 /** @brief Create a new filter matrix. */
-void Create_filter(ImagesFilters *images_filters);
+void Create_filter(ImagesFilters *images_filters, const Command *command);
 
 /** @brief Apply a filter to an image. */
-void Apply_Filter(ImagesFilters *images_filters);
+void Apply_Filter(ImagesFilters *images_filters, const Command *command);
+
+/** @brief Print the per-channel histogram of an image. */
+void Print_histogram(ImagesFilters *images_filters, const Command *command);
+
+/** @brief Print the per-channel min, max and mean of an image. */
+void Print_stats(ImagesFilters *images_filters, const Command *command);
+
+/** @brief Apply user-given per-channel lookup tables to an image. */
+void Apply_lut(ImagesFilters *images_filters, const Command *command);
+
+/** @brief Apply gamma correction to an image. */
+void Apply_gamma(ImagesFilters *images_filters, const Command *command);
+
+/** @brief Map a [low, high] range of values onto [0, 255]. */
+void Apply_levels(ImagesFilters *images_filters, const Command *command);
+
+/** @brief Stretch each channel of an image to the full [0, 255] range. */
+void Apply_autocontrast(ImagesFilters *images_filters, const Command *command);
+
+/** @brief Replace each channel value by the median of the window around it. */
+void Apply_median(ImagesFilters *images_filters, const Command *command);
+
+/** @brief Replace each channel value by the minimum of the window around it. */
+void Apply_min(ImagesFilters *images_filters, const Command *command);
+
+/** @brief Replace each channel value by the maximum of the window around it. */
+void Apply_max(ImagesFilters *images_filters, const Command *command);
+
+/** @brief Replace each channel value by the value of a given rank in the window around it. */
+void Apply_rank(ImagesFilters *images_filters, const Command *command);
 
 /** @brief Delete a filter from memory. */
-void Delete_filter(ImagesFilters *images_filters);
+void Delete_filter(ImagesFilters *images_filters, const Command *command);
 
 // Array of command-function mappings
 const CommandMap commands[] = {
-    {"l", Load_image},
-    {"s", Save_image},
-    {"ah", Apply_horizontal_flip},
-    {"ar", Apply_rotate},
-    {"ac", Apply_crop},
-    {"ae", Apply_extend},
-    {"ap", Apply_paste},
-    {"cf", Create_filter},
-    {"af", Apply_Filter},
-    {"df", Delete_filter},
-    {"di", Delete_Image},
-    {"", NULL}  // Sentinel value (end of the array)
+    {"l", "nnpL", Load_image},
+    {"lc", "nnpnnnnL", Load_image_crop},
+    {"lp", "nnpL", Load_image_planar},
+    {"pl", "I", Convert_planar},
+    {"il", "I", Convert_interleaved},
+    {"s", "iP", Save_image},
+    {"sf", "iP", Save_image_sync},
+    {"ah", "I", Apply_horizontal_flip},
+    {"ar", "I", Apply_rotate},
+    {"ac", "Innnn", Apply_crop},
+    {"ae", "Innnnn", Apply_extend},
+    {"ap", "IInn", Apply_paste},
+    {"cf", "kF", Create_filter},
+    {"af", "If", Apply_Filter},
+    {"df", "E", Delete_filter},
+    {"hg", "ic", Print_histogram},
+    {"st", "ic", Print_stats},
+    {"lu", "Iu", Apply_lut},
+    {"lg", "Iv", Apply_gamma},
+    {"ll", "Inn", Apply_levels},
+    {"la", "I", Apply_autocontrast},
+    {"md", "In", Apply_median},
+    {"mn", "In", Apply_min},
+    {"mx", "In", Apply_max},
+    {"rk", "Inn", Apply_rank},
+    {"di", "D", Delete_Image},
+    {"", "", NULL}  // Sentinel value (end of the array)
 };
 
 /**
- * @brief Execute a command given its string representation.
+ * @brief Read the arguments of a command and queue it for execution.
+ *
+ * Commands run on the scheduler's workers as soon as every earlier command
+ * touching the same images, filters, files or stdout has finished.
  *
  * @param cmd The command to execute.
  */
@@ -0,0 +1,46 @@
+#pragma once
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+
+#define MAX_WORKERS 16      // upper bound of worker threads
+
+typedef void (*TaskFunc)(void *arg);
+
+// Range [first, last] of resources read or written by a task
+typedef struct TAccess {
+    int first, last;
+    bool write;
+} Access;
+
+/**
+ * @brief Start the worker threads.
+ *
+ * @param resources Number of resources tasks may access (ids 0..resources-1).
+ * @param workers Number of worker threads.
+ */
+void scheduler_init(int resources, int workers);
+
+/**
+ * @brief Queue a task; it runs once every earlier task it conflicts with is done.
+ *
+ * Two tasks conflict when they access a common resource and at least one
+ * of them writes it, so the result is the same as running the tasks in
+ * submission order.
+ *
+ * @param func Function to run.
+ * @param arg Argument passed to func.
+ * @param accesses Resources read or written by the task.
+ * @param count Number of accesses.
+ */
+void scheduler_submit(TaskFunc func, void *arg, const Access *accesses, int count);
+
+/** @brief Wait until every submitted task has finished. */
+void scheduler_wait(void);
+
+/** @brief Wait for all tasks, then stop the workers and free the scheduler. */
+void scheduler_shutdown(void);
+
+#endif  // SCHEDULER_H
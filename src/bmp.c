@@ -1,39 +1,264 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
-void read_from_bmp(int ***pixel_matrix, int N, int M, const char *path) {
-    FILE *file = fopen(path, "rb");
-    if (!file) {
-        perror("Error opening file");
-        return;
+#include "../include/bmp.h"
+
+// Helper : Little-endian fields of the header
+static unsigned int le16(const unsigned char *bytes) {
+    return bytes[0] | (bytes[1] << 8);
+}
+
+static unsigned int le32(const unsigned char *bytes) {
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+const char *bmp_strerror(BmpStatus status) {
+    switch (status) {
+        case BMP_OK: return "ok";
+        case BMP_ERR_OPEN: return "cannot open file";
+        case BMP_ERR_HEADER: return "not a BMP file";
+        case BMP_ERR_FORMAT: return "not an uncompressed 24-bit bottom-up BMP";
+        case BMP_ERR_DIMENSIONS: return "unsupported dimensions";
+        case BMP_ERR_TRUNCATED: return "file shorter than its pixel data";
+        case BMP_ERR_MEMORY: return "out of memory";
     }
+    return "unknown error";
+}
 
-    unsigned char header[54];
-    fread(header, sizeof(unsigned char), 54, file);
+BmpStatus bmp_read_info(FILE *file, BmpInfo *info) {
+    unsigned char header[BMP_HEADER_SIZE];
 
-    int padding = (4 - (M * 3) % 4) % 4;
+    if (fseek(file, 0, SEEK_END) != 0) return BMP_ERR_HEADER;
+    long file_size = ftell(file);
+    if (file_size < BMP_HEADER_SIZE || fseek(file, 0, SEEK_SET) != 0) return BMP_ERR_HEADER;
+    if (fread(header, 1, BMP_HEADER_SIZE, file) != BMP_HEADER_SIZE) return BMP_ERR_HEADER;
+
+    if (header[0] != 'B' || header[1] != 'M') return BMP_ERR_HEADER;
+    unsigned int dib_size = le32(&header[14]);
+    unsigned int data_offset = le32(&header[10]);
+    if (dib_size < BMP_DIB_SIZE || data_offset < 14 + (unsigned long)dib_size) return BMP_ERR_HEADER;
+
+    if (le16(&header[26]) != 1 || le16(&header[28]) != 24 || le32(&header[30]) != 0) {
+        return BMP_ERR_FORMAT;
+    }
+
+    // Negative height (top-down rows) is not supported
+    int width = (int)le32(&header[18]);
+    int height = (int)le32(&header[22]);
+    if (height < 0) return BMP_ERR_FORMAT;
+    if (bmp_check_size(height, width) != BMP_OK) return BMP_ERR_DIMENSIONS;
+
+    // Every row must be present (the padding of the last one may be missing)
+    long stride = ((long)width * 3 + 3) & ~3L;
+    if ((long)data_offset + stride * (height - 1) + (long)width * 3 > file_size) {
+        return BMP_ERR_TRUNCATED;
+    }
+
+    info->width = width;
+    info->height = height;
+    info->stride = stride;
+    info->data_offset = data_offset;
+    return BMP_OK;
+}
+
+BmpStatus bmp_check_size(int N, int M) {
+    if (N <= 0 || M <= 0 || N > BMP_MAX_DIMENSION || M > BMP_MAX_DIMENSION) {
+        return BMP_ERR_DIMENSIONS;
+    }
+    if ((long long)N * M > BMP_MAX_PIXELS) return BMP_ERR_DIMENSIONS;
+    return BMP_OK;
+}
+
+BmpStatus bmp_open(const char *path, int N, int M, FILE **file, BmpInfo *info) {
+    *file = fopen(path, "rb");
+    if (!*file) return BMP_ERR_OPEN;
+
+    BmpStatus status = bmp_read_info(*file, info);
+    if (status == BMP_OK) status = bmp_check_size(N, M);
+    // Rows are split using the requested width
+    if (status == BMP_OK && M != info->width) status = BMP_ERR_DIMENSIONS;
+
+    if (status != BMP_OK) {
+        fclose(*file);
+        *file = NULL;
+    }
+    return status;
+}
+
+// Helper : Read the color (BGR) of the last stored pixel
+static BmpStatus read_last_pixel(FILE *file, const BmpInfo *info, unsigned char last[3]) {
+    long offset = info->data_offset + info->stride * (info->height - 1) + (long)(info->width - 1) * 3;
+    if (fseek(file, offset, SEEK_SET) != 0 || fread(last, 1, 3, file) != 3) {
+        return BMP_ERR_TRUNCATED;
+    }
+    return BMP_OK;
+}
+
+BmpStatus read_from_bmp_stream(FILE *file, const BmpInfo *info, int ***pixel_matrix, int N, int M) {
+    // Rows past the stored height repeat the last stored pixel
+    unsigned char last[3];
+    if (read_last_pixel(file, info, last) != BMP_OK) return BMP_ERR_TRUNCATED;
+
+    unsigned char *row = (unsigned char *)malloc(info->stride);
+    if (row == NULL) return BMP_ERR_MEMORY;
+
+    BmpStatus status = BMP_OK;
+    int rows = N < info->height ? N : info->height;
+    if (fseek(file, info->data_offset, SEEK_SET) != 0) status = BMP_ERR_TRUNCATED;
+
+    for (int i = 0; i < N && status == BMP_OK; i++) {
+        const unsigned char *color = last;
+        // The last row may lack its padding
+        if (i < rows && fread(row, 1, (size_t)M * 3, file) != (size_t)M * 3) {
+            status = BMP_ERR_TRUNCATED;
+            break;
+        }
 
-    for (int i = 0; i < N; i++) {
         for (int j = 0; j < M; j++) {
-            unsigned char color[3];
-            fread(color, sizeof(unsigned char), 3, file);
+            if (i < rows) color = row + j * 3;
             pixel_matrix[N-i-1][j][0] = (int)color[2]; // Red
             pixel_matrix[N-i-1][j][1] = (int)color[1]; // Green
             pixel_matrix[N-i-1][j][2] = (int)color[0]; // Blue
         }
-        fseek(file, padding, SEEK_CUR);
+        if (i + 1 < rows) fseek(file, info->stride - (long)M * 3, SEEK_CUR);
     }
 
+    free(row);
+    return status;
+}
+
+BmpStatus read_from_bmp(int ***pixel_matrix, int N, int M, const char *path) {
+    FILE *file = NULL;
+    BmpInfo info;
+    BmpStatus status = bmp_open(path, N, M, &file, &info);
+    if (status != BMP_OK) return status;
+
+    status = read_from_bmp_stream(file, &info, pixel_matrix, N, M);
     fclose(file);
+    return status;
 }
 
-void write_to_bmp(int ***pixel_matrix, int N, int M, const char *path) {
-    FILE *file = fopen(path, "wb");
-    if (!file) {
-        perror("Error opening file");
-        return;
+BmpStatus read_from_bmp_window_stream(FILE *file, const BmpInfo *info, int ***pixel_matrix,
+                                      int N, int M, int x, int y, int h, int w) {
+    unsigned char last[3];
+    BmpStatus status = read_last_pixel(file, info, last);
+
+    // Columns [first, end) of the window lie inside the image
+    long first = x < 0 ? -(long)x : 0;
+    long end = (long)M - x;
+    if (first > w) first = w;
+    if (end > w) end = w;
+    int cols = end > first ? (int)(end - first) : 0;
+    unsigned char *row = (unsigned char *)malloc((cols > 0 ? cols : 1) * 3);
+    if (row == NULL) status = BMP_ERR_MEMORY;
+
+    // Rows are stored bottom-up: walk the window from its last row
+    // so the file is visited with increasing offsets
+    for (int i = h - 1; i >= 0 && status == BMP_OK; i--) {
+        int src = y + i;
+        int stored = N - src - 1;  // row index inside the file
+        bool inside = cols > 0 && src >= 0 && src < N;
+
+        if (inside && stored < info->height) {
+            long offset = info->data_offset + stored * info->stride + ((long)x + first) * 3;
+            if (fseek(file, offset, SEEK_SET) != 0 ||
+                fread(row, 3, cols, file) != (size_t)cols) {
+                status = BMP_ERR_TRUNCATED;
+                break;
+            }
+        }
+
+        for (int j = 0; j < w; j++) {
+            const unsigned char *color = NULL;
+            if (inside && j >= first && j < first + cols) {
+                color = stored < info->height ? row + (j - first) * 3 : last;
+            }
+
+            if (color != NULL) {
+                pixel_matrix[i][j][0] = (int)color[2]; // Red
+                pixel_matrix[i][j][1] = (int)color[1]; // Green
+                pixel_matrix[i][j][2] = (int)color[0]; // Blue
+            } else {
+                // Outside the source image (same as crop)
+                pixel_matrix[i][j][0] = 0;
+                pixel_matrix[i][j][1] = 0;
+                pixel_matrix[i][j][2] = 0;
+            }
+        }
     }
 
+    free(row);
+    return status;
+}
+
+BmpStatus read_from_bmp_planar_stream(FILE *file, const BmpInfo *info, unsigned char *planes, int N, int M) {
+    unsigned char last[3];
+    BmpStatus status = read_last_pixel(file, info, last);
+
+    size_t plane = (size_t)N * M;
+    int rows = N < info->height ? N : info->height;
+    unsigned char *row = (unsigned char *)malloc(info->stride);
+    if (row == NULL) status = BMP_ERR_MEMORY;
+    if (status == BMP_OK && fseek(file, info->data_offset, SEEK_SET) != 0) status = BMP_ERR_TRUNCATED;
+
+    for (int i = 0; i < N && status == BMP_OK; i++) {
+        unsigned char *red = planes + (size_t)(N - i - 1) * M;
+        unsigned char *green = red + plane;
+        unsigned char *blue = green + plane;
+
+        if (i >= rows) {
+            // Past the stored height : repeat the last stored pixel
+            memset(red, last[2], M);
+            memset(green, last[1], M);
+            memset(blue, last[0], M);
+            continue;
+        }
+
+        // Whole row at once (the last one may lack its padding)
+        size_t size = i + 1 < rows ? (size_t)info->stride : (size_t)M * 3;
+        if (fread(row, 1, size, file) != size) {
+            status = BMP_ERR_TRUNCATED;
+            break;
+        }
+
+        // Split BGR triplets into the R, G and B planes
+        for (int j = 0; j < M; j++) {
+            red[j] = row[j * 3 + 2];
+            green[j] = row[j * 3 + 1];
+            blue[j] = row[j * 3];
+        }
+    }
+
+    free(row);
+    return status;
+}
+
+// Write the whole buffer, retrying on short writes and interrupts
+static int write_all(int fd, const unsigned char *buffer, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, buffer, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        buffer += written;
+        size -= (size_t)written;
+    }
+    return 0;
+}
+
+// Fills one BMP row (BGR + padding left to the caller) from image row src
+typedef void (*EncodeRow)(unsigned char *row, int src, int N, int M, const void *pixels);
+
+static int write_bmp_rows(int N, int M, const char *path, BmpSync sync,
+                          EncodeRow encode, const void *pixels) {
     unsigned char header[54] = {
         0x42, 0x4D, // BMP signature
         0, 0, 0, 0, // File size
@@ -53,24 +278,84 @@ void write_to_bmp(int ***pixel_matrix, int N, int M, const char *path) {
     };
 
     int padding = (4 - (M * 3) % 4) % 4;
+    size_t row_size = (size_t)M * 3 + padding;
     int fileSize = 54 + (3 * M + padding) * N;
     *(int *)&header[2] = fileSize;
     *(int *)&header[18] = M;
     *(int *)&header[22] = N;
 
-    fwrite(header, sizeof(unsigned char), 54, file);
+    // Batch as many whole rows as fit in the write buffer
+    size_t capacity = BMP_WRITE_BUFFER;
+    if (capacity < sizeof(header) + row_size) {
+        capacity = sizeof(header) + row_size;
+    }
+    unsigned char *buffer = NULL;
+    if (posix_memalign((void **)&buffer, BMP_BUFFER_ALIGN, capacity) != 0) {
+        fprintf(stderr, "[ERROR] : Allocate BMP write buffer...\n");
+        return -1;
+    }
 
-    unsigned char pad[3] = {0, 0, 0};
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < M; j++) {
-            unsigned char color[3];
-            color[2] = (unsigned char)(pixel_matrix[N-i-1][j][0]); // Red
-            color[1] = (unsigned char)(pixel_matrix[N-i-1][j][1]); // Green
-            color[0] = (unsigned char)(pixel_matrix[N-i-1][j][2]); // Blue
-            fwrite(color, sizeof(unsigned char), 3, file);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("Error opening file");
+        free(buffer);
+        return -1;
+    }
+
+    memcpy(buffer, header, sizeof(header));
+    size_t used = sizeof(header);
+    int status = 0;
+
+    for (int i = 0; i < N && status == 0; i++) {
+        if (used + row_size > capacity) {
+            status = write_all(fd, buffer, used);
+            used = 0;
         }
-        fwrite(pad, sizeof(unsigned char), padding, file);
+
+        unsigned char *row = buffer + used;
+        encode(row, N-i-1, N, M, pixels);
+        memset(row + (size_t)M * 3, 0, padding);
+        used += row_size;
     }
 
-    fclose(file);
-}
\ No newline at end of file
+    if (status == 0) status = write_all(fd, buffer, used);
+    if (status == 0 && sync == BMP_SYNC_DATA) status = fdatasync(fd);
+    if (status != 0) perror("Error writing file");
+
+    if (close(fd) != 0 && status == 0) {
+        perror("Error closing file");
+        status = -1;
+    }
+
+    free(buffer);
+    return status;
+}
+
+static void encode_interleaved(unsigned char *row, int src, int N, int M, const void *pixels) {
+    int ***pixel_matrix = (int ***)pixels;
+    for (int j = 0; j < M; j++) {
+        row[j * 3 + 2] = (unsigned char)(pixel_matrix[src][j][0]); // Red
+        row[j * 3 + 1] = (unsigned char)(pixel_matrix[src][j][1]); // Green
+        row[j * 3]     = (unsigned char)(pixel_matrix[src][j][2]); // Blue
+    }
+}
+
+static void encode_planar(unsigned char *row, int src, int N, int M, const void *pixels) {
+    size_t plane = (size_t)N * M;
+    const unsigned char *red = (const unsigned char *)pixels + (size_t)src * M;
+    const unsigned char *green = red + plane;
+    const unsigned char *blue = green + plane;
+    for (int j = 0; j < M; j++) {
+        row[j * 3 + 2] = red[j];
+        row[j * 3 + 1] = green[j];
+        row[j * 3]     = blue[j];
+    }
+}
+
+int write_to_bmp(int ***pixel_matrix, int N, int M, const char *path, BmpSync sync) {
+    return write_bmp_rows(N, M, path, sync, encode_interleaved, pixel_matrix);
+}
+
+int write_to_bmp_planar(const unsigned char *planes, int N, int M, const char *path, BmpSync sync) {
+    return write_bmp_rows(N, M, path, sync, encode_planar, planes);
+}
@@ -36,7 +36,11 @@ int main(int argc, char **argv) {
     }
 
     // Read the image
-    read_from_bmp(image, N, M, image_path);
+    BmpStatus status = read_from_bmp(image, N, M, image_path);
+    if (status != BMP_OK) {
+        printf("Invalid image: %s.\n", bmp_strerror(status));
+        return 1;
+    }
 
     // Apply the transformation based on the task number
     switch (task) {
@@ -71,7 +75,11 @@ int main(int argc, char **argv) {
                 }
             }
 
-            read_from_bmp(image2, N2, M2, image_path2);
+            status = read_from_bmp(image2, N2, M2, image_path2);
+            if (status != BMP_OK) {
+                printf("Invalid image: %s.\n", bmp_strerror(status));
+                return 1;
+            }
             scanf("%d %d", &x, &y);
 
             image = paste(image, N, M, image2, N2, M2, x, y);
@@ -100,7 +108,7 @@ int main(int argc, char **argv) {
     }
 
     // Save the transformed image
-    write_to_bmp(image, N, M, output_file);
+    write_to_bmp(image, N, M, output_file, BMP_SYNC_NONE);
 
     // Free memory
     for (int i = 0; i < N; i++) {
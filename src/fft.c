@@ -0,0 +1,203 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "../include/fft.h"
+#include "../include/imageprocessing.h"
+
+// Sums are truncated like the direct path; absorb round-off below an integer
+#define FFT_ROUNDING_EPS 1e-6
+
+FftPlan *fft_plan(int n) {
+    FftPlan *plan = (FftPlan *)malloc(sizeof(FftPlan));
+    if (plan == NULL) return NULL;
+
+    plan->n = n;
+    plan->twiddle = (Complex *)malloc((n / 2 > 0 ? n / 2 : 1) * sizeof(Complex));
+    plan->reverse = (int *)malloc(n * sizeof(int));
+    if (plan->twiddle == NULL || plan->reverse == NULL) {
+        fprintf(stderr, "[ERROR] : Allocate FFT plan...\n");
+        fft_free(plan);
+        return NULL;
+    }
+
+    for (int k = 0; k < n / 2; ++k) {
+        double angle = -2.0 * M_PI * k / n;
+        plan->twiddle[k].re = cos(angle);
+        plan->twiddle[k].im = sin(angle);
+    }
+
+    int bits = 0;
+    while ((1 << bits) < n) ++bits;
+    for (int i = 0; i < n; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+        }
+        plan->reverse[i] = r;
+    }
+
+    return plan;
+}
+
+void fft_free(FftPlan *plan) {
+    if (plan != NULL) {
+        free(plan->twiddle);
+        free(plan->reverse);
+        free(plan);
+    }
+}
+
+void fft(const FftPlan *plan, Complex *data, int inverse) {
+    int n = plan->n;
+
+    // Bit-reversal permutation
+    for (int i = 0; i < n; ++i) {
+        int j = plan->reverse[i];
+        if (i < j) {
+            Complex tmp = data[i];
+            data[i] = data[j];
+            data[j] = tmp;
+        }
+    }
+
+    // Radix-2 butterflies
+    for (int len = 2; len <= n; len <<= 1) {
+        int half = len / 2;
+        int step = n / len;
+        for (int start = 0; start < n; start += len) {
+            for (int k = 0; k < half; ++k) {
+                Complex w = plan->twiddle[k * step];
+                if (inverse) w.im = -w.im;
+
+                Complex *a = &data[start + k];
+                Complex *b = &data[start + k + half];
+                Complex v = {b->re * w.re - b->im * w.im, b->re * w.im + b->im * w.re};
+                b->re = a->re - v.re;
+                b->im = a->im - v.im;
+                a->re += v.re;
+                a->im += v.im;
+            }
+        }
+    }
+}
+
+// Helper : 2D FFT of a n x n block (rows, then columns through scratch)
+static void fft2d(const FftPlan *plan, Complex *data, Complex *scratch, int inverse) {
+    int n = plan->n;
+
+    for (int i = 0; i < n; ++i) {
+        fft(plan, data + (size_t)i * n, inverse);
+    }
+    for (int j = 0; j < n; ++j) {
+        for (int i = 0; i < n; ++i) scratch[i] = data[(size_t)i * n + j];
+        fft(plan, scratch, inverse);
+        for (int i = 0; i < n; ++i) data[(size_t)i * n + j] = scratch[i];
+    }
+}
+
+int ***apply_filter_fft(int ***image, int N, int M, float **filter, int filter_size) {
+    int K = filter_size;
+    int center = K / 2;
+
+    // FFT size P, each tile contributes T x T input pixels
+    int P = FFT_MIN_SIZE;
+    while (P < 4 * K) P <<= 1;
+    int T = P - K + 1;
+    int W = M + K - 1;  // width of the full convolution
+
+    int ***new_image = allocate_image(N, M);
+    FftPlan *plan = fft_plan(P);
+    Complex *kernel = (Complex *)calloc((size_t)P * P, sizeof(Complex));
+    Complex *tile = (Complex *)malloc((size_t)P * P * sizeof(Complex));
+    Complex *scratch = (Complex *)malloc(P * sizeof(Complex));
+    // Accumulates P full-convolution rows of each channel
+    double *band = (double *)calloc((size_t)3 * P * W, sizeof(double));
+
+    if (new_image == NULL || plan == NULL || kernel == NULL ||
+        tile == NULL || scratch == NULL || band == NULL) {
+        fprintf(stderr, "[ERROR] : Allocate FFT convolution buffers...\n");
+        free_image(new_image, N, M);
+        new_image = NULL;
+        goto cleanup;
+    }
+
+    // apply_filter correlates : convolve with the flipped kernel
+    for (int a = 0; a < K; ++a) {
+        for (int b = 0; b < K; ++b) {
+            kernel[(size_t)a * P + b].re = filter[K - 1 - a][K - 1 - b];
+        }
+    }
+    fft2d(plan, kernel, scratch, 0);
+
+    double scale = 1.0 / ((double)P * P);
+
+    for (int ti = 0; ti < N; ti += T) {
+        int h = (T < N - ti) ? T : N - ti;
+
+        for (int tj = 0; tj < M; tj += T) {
+            int w = (T < M - tj) ? T : M - tj;
+
+            // Pass 0 packs R + iG into one transform, pass 1 carries B
+            for (int pass = 0; pass < 2; ++pass) {
+                memset(tile, 0, (size_t)P * P * sizeof(Complex));
+                for (int i = 0; i < h; ++i) {
+                    for (int j = 0; j < w; ++j) {
+                        int *pixel = image[ti + i][tj + j];
+                        tile[(size_t)i * P + j].re = pass ? pixel[2] : pixel[0];
+                        tile[(size_t)i * P + j].im = pass ? 0 : pixel[1];
+                    }
+                }
+
+                fft2d(plan, tile, scratch, 0);
+                for (size_t p = 0; p < (size_t)P * P; ++p) {
+                    Complex t = tile[p], k = kernel[p];
+                    tile[p].re = t.re * k.re - t.im * k.im;
+                    tile[p].im = t.re * k.im + t.im * k.re;
+                }
+                fft2d(plan, tile, scratch, 1);
+
+                // Overlap-add the (h + K - 1) x (w + K - 1) result
+                double *first = band + (size_t)(pass ? 2 : 0) * P * W;
+                double *second = band + (size_t)1 * P * W;
+                for (int i = 0; i < h + K - 1; ++i) {
+                    for (int j = 0; j < w + K - 1; ++j) {
+                        Complex v = tile[(size_t)i * P + j];
+                        first[(size_t)i * W + tj + j] += v.re * scale;
+                        if (!pass) second[(size_t)i * W + tj + j] += v.im * scale;
+                    }
+                }
+            }
+        }
+
+        // Rows before ti + T receive nothing from later tiles
+        int done = (ti + T >= N) ? h + K - 1 : T;
+        for (int i = 0; i < done; ++i) {
+            int row = ti + i - center;
+            if (row < 0 || row >= N) continue;
+
+            for (int j = 0; j < M; ++j) {
+                for (int k = 0; k < 3; ++k) {
+                    double value = band[(size_t)k * P * W + (size_t)i * W + j + center];
+                    new_image[row][j][k] = clamp((int)(value + FFT_ROUNDING_EPS), 0, MAX_PIXEL_VALUE);
+                }
+            }
+        }
+
+        // Keep the K - 1 overlapping rows for the next band of tiles
+        for (int k = 0; k < 3; ++k) {
+            double *channel = band + (size_t)k * P * W;
+            memmove(channel, channel + (size_t)T * W, (size_t)(K - 1) * W * sizeof(double));
+            memset(channel + (size_t)(K - 1) * W, 0, (size_t)(P - K + 1) * W * sizeof(double));
+        }
+    }
+
+cleanup:
+    fft_free(plan);
+    free(kernel);
+    free(tile);
+    free(scratch);
+    free(band);
+    return new_image;
+}
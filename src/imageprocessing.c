@@ -1,7 +1,15 @@
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "../include/imageprocessing.h"
+#include "../include/fft.h"
 
 // Helper : Find most appropriate range value
 int clamp(int value, int min, int max) {
@@ -10,6 +18,73 @@ int clamp(int value, int min, int max) {
     return value;
 }
 
+// Helper : Run task over bands of rows [begin, end), one band per thread
+typedef void (*RowTask)(int band, int begin, int end, void *arg);
+
+typedef struct {
+    RowTask task;
+    void *arg;
+    int band, begin, end;
+} RowBand;
+
+static void *run_row_band(void *arg) {
+    RowBand *band = (RowBand *)arg;
+    band->task(band->band, band->begin, band->end, band->arg);
+    return NULL;
+}
+
+// Operations running at the same time, the CPUs are shared between them
+static atomic_int parallel_callers;
+
+void parallel_enter(void) {
+    atomic_fetch_add(&parallel_callers, 1);
+}
+
+void parallel_leave(void) {
+    atomic_fetch_sub(&parallel_callers, 1);
+}
+
+static int parallel_threads(int N, int M) {
+    // Small images are not worth the thread start-up cost
+    if ((long)N * M < PARALLEL_MIN_PIXELS) return 1;
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int callers = atomic_load(&parallel_callers);
+    if (callers > 1) cpus /= callers;
+    int threads = cpus > 0 ? (int)cpus : 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+    if (threads > N) threads = N;
+    return threads > 0 ? threads : 1;
+}
+
+static void parallel_rows(int N, int threads, RowTask task, void *arg) {
+    pthread_t ids[MAX_THREADS];
+    RowBand bands[MAX_THREADS];
+    int started = 0;
+
+    for (int t = 0; t < threads; ++t) {
+        bands[t].task = task;
+        bands[t].arg = arg;
+        bands[t].band = t;
+        bands[t].begin = (int)((long)N * t / threads);
+        bands[t].end = (int)((long)N * (t + 1) / threads);
+    }
+
+    // The calling thread takes the first band itself
+    for (int t = 1; t < threads; ++t) {
+        if (pthread_create(&ids[t], NULL, run_row_band, &bands[t]) != 0) break;
+        started = t;
+    }
+    run_row_band(&bands[0]);
+    // Bands whose thread could not be started run here
+    for (int t = started + 1; t < threads; ++t) {
+        run_row_band(&bands[t]);
+    }
+    for (int t = 1; t <= started; ++t) {
+        pthread_join(ids[t], NULL);
+    }
+}
+
 int ***allocate_image(int N, int M) {
     // Allocate memory for the image pointer
     int ***image = (int ***)malloc(N * sizeof(int **));
@@ -156,7 +231,37 @@ int ***paste(int ***image_dst, int N_dst, int M_dst, int ***image_src, int N_src
     return image_dst;
 }
 
-int ***apply_filter(int ***image, int N, int M, float **filter, int filter_size) {
+// Helper : Filter one pixel, skipping neighbors outside the image
+static inline void filter_pixel(int ***image, int N, int M, float **filter, int center,
+                                int i, int j, int *out) {
+    float R = 0, G = 0, B = 0;
+
+    // Apply the filter to the neighbors of each pixel
+    for (int k = -center; k <= center; ++k) {
+        for (int l = -center; l <= center; ++l) {
+            // Calculate the coordinates of the neighbor
+            int x = i + k;
+            int y = j + l;
+
+            // Check if the neighbor is within the image boundaries
+            if (x >= 0 && x < N && y >= 0 && y < M) {
+                // Apply the filter to each color channel
+                int filter_i = k + center;
+                int filter_j = l + center;
+                R += (float)image[x][y][0] * filter[filter_i][filter_j];
+                G += (float)image[x][y][1] * filter[filter_i][filter_j];
+                B += (float)image[x][y][2] * filter[filter_i][filter_j];
+            }
+        }
+    }
+
+    // Round and clamp the resulting values
+    out[0] = clamp((int)R, 0, MAX_PIXEL_VALUE);
+    out[1] = clamp((int)G, 0, MAX_PIXEL_VALUE);
+    out[2] = clamp((int)B, 0, MAX_PIXEL_VALUE);
+}
+
+static int ***apply_filter_direct(int ***image, int N, int M, float **filter, int filter_size) {
     int ***new_image = allocate_image(N, M);
     if (new_image == NULL) return NULL;
 
@@ -165,38 +270,684 @@ int ***apply_filter(int ***image, int N, int M, float **filter, int filter_size)
     // Apply filter
     for (int i = 0; i < N; ++i) {
         for (int j = 0; j < M; ++j) {
-            float R = 0, G = 0, B = 0;
-
-            // Apply the filter to the neighbors of each pixel
-            for (int k = -center; k <= center; ++k) {
-                for (int l = -center; l <= center; ++l) {
-                    // Calculate the coordinates of the neighbor
-                    int x = i + k;
-                    int y = j + l;
-
-                    // Check if the neighbor is within the image boundaries
-                    if (x >= 0 && x < N && y >= 0 && y < M) {
-                        // Apply the filter to each color channel
-                        int filter_i = k + center;
-                        int filter_j = l + center;
-                        R += (float)image[x][y][0] * filter[filter_i][filter_j];
-                        G += (float)image[x][y][1] * filter[filter_i][filter_j];
-                        B += (float)image[x][y][2] * filter[filter_i][filter_j];
-                    }
+            filter_pixel(image, N, M, filter, center, i, j, new_image[i][j]);
+        }
+    }
+
+    return new_image;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#define FILTER_PRAGMA(x) _Pragma(#x)
+#define FILTER_UNROLL(n) FILTER_PRAGMA(GCC unroll n)
+#else
+#define FILTER_UNROLL(n)
+#endif
+
+/*
+ * Generate apply_filter_SxS : the filter size is a compile-time constant,
+ * so the tap loops unroll and the coefficients stay in locals. Interior
+ * pixels skip the bounds checks; taps are summed in the same order as
+ * filter_pixel, which still handles the border, so results are identical.
+ */
+#define DEFINE_FILTER_KERNEL(SIZE)                                              \
+static int ***apply_filter_##SIZE##x##SIZE(int ***image, int N, int M,          \
+                                           float **filter) {                    \
+    int ***new_image = allocate_image(N, M);                                    \
+    if (new_image == NULL) return NULL;                                         \
+                                                                                \
+    const int center = SIZE / 2;                                                \
+    float taps[SIZE][SIZE];                                                     \
+    for (int k = 0; k < SIZE; ++k) {                                            \
+        for (int l = 0; l < SIZE; ++l) {                                        \
+            taps[k][l] = filter[k][l];                                          \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    for (int i = 0; i < N; ++i) {                                               \
+        int border_row = i < center || i >= N - center;                         \
+        for (int j = 0; j < M; ++j) {                                           \
+            if (border_row || j < center || j >= M - center) {                  \
+                filter_pixel(image, N, M, filter, center, i, j, new_image[i][j]); \
+                continue;                                                       \
+            }                                                                   \
+                                                                                \
+            float R = 0, G = 0, B = 0;                                          \
+            FILTER_UNROLL(SIZE)                                                 \
+            for (int k = 0; k < SIZE; ++k) {                                    \
+                int **row = image[i + k - center] + (j - center);               \
+                FILTER_UNROLL(SIZE)                                             \
+                for (int l = 0; l < SIZE; ++l) {                                \
+                    const int *pixel = row[l];                                  \
+                    R += (float)pixel[0] * taps[k][l];                          \
+                    G += (float)pixel[1] * taps[k][l];                          \
+                    B += (float)pixel[2] * taps[k][l];                          \
+                }                                                               \
+            }                                                                   \
+                                                                                \
+            new_image[i][j][0] = clamp((int)R, 0, MAX_PIXEL_VALUE);             \
+            new_image[i][j][1] = clamp((int)G, 0, MAX_PIXEL_VALUE);             \
+            new_image[i][j][2] = clamp((int)B, 0, MAX_PIXEL_VALUE);             \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    return new_image;                                                           \
+}
+
+DEFINE_FILTER_KERNEL(3)
+DEFINE_FILTER_KERNEL(5)
+DEFINE_FILTER_KERNEL(7)
+
+// Helper : Seconds spent in one filter call (result discarded)
+// Helper : Best of FFT_CALIBRATION_RUNS timings of a filter function
+static double time_filter(int ***(*filter_func)(int ***, int, int, float **, int),
+                          int ***image, int N, int M, float **filter, int filter_size) {
+    double best = -1;
+    for (int run = 0; run < FFT_CALIBRATION_RUNS; ++run) {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        int ***result = filter_func(image, N, M, filter, filter_size);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        free_image(result, N, M);
+
+        double elapsed = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) * 1e-9;
+        if (best < 0 || elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+// Helper : Crossover fixed at build time or by the environment, 0 if none
+static int pinned_fft_crossover(void) {
+#ifdef FFT_CROSSOVER
+    return FFT_CROSSOVER;
+#else
+    const char *value = getenv("FFT_CROSSOVER");
+    if (value == NULL || *value == '\0') return 0;
+
+    char *end = NULL;
+    long size = strtol(value, &end, 10);
+    if (*end != '\0' || size <= 0 || size > INT_MAX) {
+        fprintf(stderr, "[ERROR] : Invalid FFT_CROSSOVER, measuring it instead...\n");
+        return 0;
+    }
+    return (int)size;
+#endif
+}
+
+static int fft_crossover = FFT_MAX_CROSSOVER;
+static pthread_once_t fft_crossover_once = PTHREAD_ONCE_INIT;
+
+// Helper : Find the smallest odd filter size for which FFT beats the direct loop
+static void measure_fft_crossover(void) {
+    int pinned = pinned_fft_crossover();
+    if (pinned > 0) {
+        fft_crossover = pinned;
+        return;
+    }
+
+    int ***image = allocate_image(FFT_CALIBRATION_SIZE, FFT_CALIBRATION_SIZE);
+    float **filter = (float **)malloc(FFT_MAX_CROSSOVER * sizeof(float *));
+    if (image == NULL || filter == NULL) {
+        free_image(image, FFT_CALIBRATION_SIZE, FFT_CALIBRATION_SIZE);
+        free(filter);
+        return;
+    }
+
+    for (int i = 0; i < FFT_CALIBRATION_SIZE; ++i) {
+        for (int j = 0; j < FFT_CALIBRATION_SIZE; ++j) {
+            for (int k = 0; k < 3; ++k) {
+                image[i][j][k] = (i * 7 + j * 13 + k * 31) % (MAX_PIXEL_VALUE + 1);
+            }
+        }
+    }
+
+    int rows = 0;
+    for (; rows < FFT_MAX_CROSSOVER; ++rows) {
+        filter[rows] = (float *)malloc(FFT_MAX_CROSSOVER * sizeof(float));
+        if (filter[rows] == NULL) break;
+    }
+
+    if (rows == FFT_MAX_CROSSOVER) {
+        for (int size = FFT_MIN_CROSSOVER; size < FFT_MAX_CROSSOVER; size += 2) {
+            for (int i = 0; i < size; ++i) {
+                for (int j = 0; j < size; ++j) {
+                    filter[i][j] = 1.0f / (float)(size * size);
                 }
             }
 
-            // Round and clamp the resulting values
-            int new_R = clamp((int)R, 0, MAX_PIXEL_VALUE);
-            int new_G = clamp((int)G, 0, MAX_PIXEL_VALUE);
-            int new_B = clamp((int)B, 0, MAX_PIXEL_VALUE);
+            double direct = time_filter(apply_filter_direct, image, FFT_CALIBRATION_SIZE,
+                                        FFT_CALIBRATION_SIZE, filter, size);
+            double fft = time_filter(apply_filter_fft, image, FFT_CALIBRATION_SIZE,
+                                     FFT_CALIBRATION_SIZE, filter, size);
+            // Sizes where both paths are about as fast would flip between runs
+            if (fft * FFT_CALIBRATION_MARGIN < direct) {
+                fft_crossover = size;
+                break;
+            }
+        }
+    }
+
+    free_filter(filter, rows);
+    free_image(image, FFT_CALIBRATION_SIZE, FFT_CALIBRATION_SIZE);
+}
+
+void calibrate_fft_crossover(void) {
+    pthread_once(&fft_crossover_once, measure_fft_crossover);
+}
+
+// Helper : Large odd kernels go through FFT once they are measured to be faster
+static int use_fft(int filter_size) {
+    if (filter_size % 2 == 0 || filter_size < FFT_MIN_CROSSOVER) return 0;
+    calibrate_fft_crossover();
+    return filter_size >= fft_crossover;
+}
+
+int ***apply_filter(int ***image, int N, int M, float **filter, int filter_size) {
+    // Common small sizes have compile-time specialized kernels
+    switch (filter_size) {
+        case 3: return apply_filter_3x3(image, N, M, filter);
+        case 5: return apply_filter_5x5(image, N, M, filter);
+        case 7: return apply_filter_7x7(image, N, M, filter);
+        default: break;
+    }
+
+    if (use_fft(filter_size)) {
+        return apply_filter_fft(image, N, M, filter, filter_size);
+    }
+
+    return apply_filter_direct(image, N, M, filter, filter_size);
+}
+
+typedef struct {
+    int ***image;
+    int M;
+    unsigned long (*partial)[3][HISTOGRAM_BINS];  // one histogram per band
+} HistogramTask;
+
+static void histogram_rows(int band, int begin, int end, void *arg) {
+    HistogramTask *ctx = (HistogramTask *)arg;
+    unsigned long (*histogram)[HISTOGRAM_BINS] = ctx->partial[band];
+
+    for (int i = begin; i < end; ++i) {
+        for (int j = 0; j < ctx->M; ++j) {
+            int *pixel = ctx->image[i][j];
+            histogram[0][clamp(pixel[0], 0, MAX_PIXEL_VALUE)]++;
+            histogram[1][clamp(pixel[1], 0, MAX_PIXEL_VALUE)]++;
+            histogram[2][clamp(pixel[2], 0, MAX_PIXEL_VALUE)]++;
+        }
+    }
+}
+
+void compute_histogram(int ***image, int N, int M, unsigned long histogram[3][HISTOGRAM_BINS]) {
+    int threads = parallel_threads(N, M);
+    unsigned long partial[MAX_THREADS][3][HISTOGRAM_BINS];
+    memset(partial, 0, (size_t)threads * sizeof(partial[0]));
+
+    HistogramTask ctx = {image, M, partial};
+    parallel_rows(N, threads, histogram_rows, &ctx);
+
+    // Merge the per-band histograms
+    memset(histogram, 0, 3 * HISTOGRAM_BINS * sizeof(unsigned long));
+    for (int t = 0; t < threads; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            for (int v = 0; v < HISTOGRAM_BINS; ++v) {
+                histogram[k][v] += partial[t][k][v];
+            }
+        }
+    }
+}
+
+void compute_stats(unsigned long histogram[3][HISTOGRAM_BINS], ChannelStats stats[3]) {
+    for (int k = 0; k < 3; ++k) {
+        unsigned long count = 0;
+        double sum = 0;
+        stats[k].min = 0;
+        stats[k].max = 0;
+
+        for (int v = 0; v < HISTOGRAM_BINS; ++v) {
+            if (histogram[k][v] == 0) continue;
+            if (count == 0) stats[k].min = v;
+            stats[k].max = v;
+            count += histogram[k][v];
+            sum += (double)v * (double)histogram[k][v];
+        }
+        stats[k].mean = count ? sum / (double)count : 0.0;
+    }
+}
 
-            new_image[i][j][0] = new_R;
-            new_image[i][j][1] = new_G;
-            new_image[i][j][2] = new_B;
+typedef struct {
+    int ***image;
+    int M;
+    unsigned char (*lut)[HISTOGRAM_BINS];
+} LutTask;
+
+static void lut_rows(int band, int begin, int end, void *arg) {
+    LutTask *ctx = (LutTask *)arg;
+
+    for (int i = begin; i < end; ++i) {
+        for (int j = 0; j < ctx->M; ++j) {
+            int *pixel = ctx->image[i][j];
+            pixel[0] = ctx->lut[0][clamp(pixel[0], 0, MAX_PIXEL_VALUE)];
+            pixel[1] = ctx->lut[1][clamp(pixel[1], 0, MAX_PIXEL_VALUE)];
+            pixel[2] = ctx->lut[2][clamp(pixel[2], 0, MAX_PIXEL_VALUE)];
         }
     }
+}
+
+int ***apply_lut(int ***image, int N, int M, unsigned char lut[3][HISTOGRAM_BINS]) {
+    LutTask ctx = {image, M, lut};
+    parallel_rows(N, parallel_threads(N, M), lut_rows, &ctx);
+    return image;
+}
+
+void gamma_lut(float gamma, unsigned char lut[3][HISTOGRAM_BINS]) {
+    for (int v = 0; v < HISTOGRAM_BINS; ++v) {
+        float value = MAX_PIXEL_VALUE * powf((float)v / MAX_PIXEL_VALUE, 1.0f / gamma);
+        lut[0][v] = lut[1][v] = lut[2][v] =
+            (unsigned char)clamp((int)(value + 0.5f), 0, MAX_PIXEL_VALUE);
+    }
+}
+
+// Helper : Stretch [low, high] of one channel linearly to [0, 255]
+static void stretch_channel(int low, int high, unsigned char lut[HISTOGRAM_BINS]) {
+    for (int v = 0; v < HISTOGRAM_BINS; ++v) {
+        if (high <= low) {
+            // Empty range : hard threshold at low
+            lut[v] = v < low ? 0 : MAX_PIXEL_VALUE;
+            continue;
+        }
+        float value = (float)(v - low) * MAX_PIXEL_VALUE / (float)(high - low);
+        lut[v] = (unsigned char)clamp((int)(value + 0.5f), 0, MAX_PIXEL_VALUE);
+    }
+}
+
+void levels_lut(int low, int high, unsigned char lut[3][HISTOGRAM_BINS]) {
+    for (int k = 0; k < 3; ++k) {
+        stretch_channel(low, high, lut[k]);
+    }
+}
+
+void autocontrast_lut(unsigned long histogram[3][HISTOGRAM_BINS], unsigned char lut[3][HISTOGRAM_BINS]) {
+    ChannelStats stats[3];
+    compute_stats(histogram, stats);
+    for (int k = 0; k < 3; ++k) {
+        if (stats[k].min < stats[k].max) {
+            stretch_channel(stats[k].min, stats[k].max, lut[k]);
+        } else {
+            // Flat channel : nothing to stretch
+            for (int v = 0; v < HISTOGRAM_BINS; ++v) lut[k][v] = (unsigned char)v;
+        }
+    }
+}
+
+unsigned char *allocate_planes(int N, int M) {
+    void *planes = NULL;
+    size_t size = (size_t)3 * N * M;
+    if (posix_memalign(&planes, PLANE_ALIGN, size > 0 ? size : 1) != 0) {
+        fprintf(stderr, "[ERROR] : Allocate BMP image planes...\n");
+        return NULL;
+    }
+    return (unsigned char *)planes;
+}
+
+unsigned char *to_planar(int ***image, int N, int M) {
+    unsigned char *planes = allocate_planes(N, M);
+    if (planes == NULL) return NULL;
+
+    size_t plane = (size_t)N * M;
+    for (int i = 0; i < N; ++i) {
+        unsigned char *red = planes + (size_t)i * M;
+        for (int j = 0; j < M; ++j) {
+            red[j] = (unsigned char)clamp(image[i][j][0], 0, MAX_PIXEL_VALUE);
+            red[j + plane] = (unsigned char)clamp(image[i][j][1], 0, MAX_PIXEL_VALUE);
+            red[j + 2 * plane] = (unsigned char)clamp(image[i][j][2], 0, MAX_PIXEL_VALUE);
+        }
+    }
+
+    return planes;
+}
+
+int ***to_interleaved(const unsigned char *planes, int N, int M) {
+    int ***image = allocate_image(N, M);
+    if (image == NULL) return NULL;
+
+    size_t plane = (size_t)N * M;
+    for (int i = 0; i < N; ++i) {
+        const unsigned char *red = planes + (size_t)i * M;
+        for (int j = 0; j < M; ++j) {
+            image[i][j][0] = red[j];
+            image[i][j][1] = red[j + plane];
+            image[i][j][2] = red[j + 2 * plane];
+        }
+    }
+
+    return image;
+}
+
+typedef struct {
+    const unsigned char *src;
+    unsigned char *dst;
+    int N, M;
+    float **filter;
+    int filter_size;
+    float *acc;  // one row of sums per band
+} PlaneFilterTask;
+
+// Helper : acc[j] += row[j] * tap over a whole row, vectorizes per channel
+static void accumulate_row(float *restrict acc, const unsigned char *restrict row, float tap, int count) {
+    #pragma omp simd
+    for (int j = 0; j < count; ++j) {
+        acc[j] += (float)row[j] * tap;
+    }
+}
+
+// Rows [begin, end) index the 3 * N rows of the R, G and B planes
+static void filter_plane_rows(int band, int begin, int end, void *arg) {
+    PlaneFilterTask *ctx = (PlaneFilterTask *)arg;
+    int N = ctx->N, M = ctx->M;
+    int center = ctx->filter_size / 2;
+    float *acc = ctx->acc + (size_t)band * M;
+
+    for (int r = begin; r < end; ++r) {
+        size_t plane = (size_t)(r / N) * N * M;
+        int i = r % N;
+        const unsigned char *src = ctx->src + plane;
+
+        for (int j = 0; j < M; ++j) acc[j] = 0;
+
+        // Same tap order as the interleaved path; out-of-image taps are skipped
+        for (int k = 0; k < ctx->filter_size; ++k) {
+            int x = i + k - center;
+            if (x < 0 || x >= N) continue;
+
+            const unsigned char *row = src + (size_t)x * M;
+            for (int l = 0; l < ctx->filter_size; ++l) {
+                int d = l - center;
+                int first = d < 0 ? -d : 0;
+                int last = d > 0 ? M - d : M;
+                if (first < last) {
+                    accumulate_row(acc + first, row + first + d, ctx->filter[k][l], last - first);
+                }
+            }
+        }
+
+        unsigned char *dst = ctx->dst + plane + (size_t)i * M;
+        for (int j = 0; j < M; ++j) {
+            dst[j] = (unsigned char)clamp((int)acc[j], 0, MAX_PIXEL_VALUE);
+        }
+    }
+}
+
+unsigned char *apply_filter_planar(const unsigned char *planes, int N, int M,
+                                   float **filter, int filter_size) {
+    if (use_fft(filter_size)) {
+        // The FFT path works on interleaved pixels, conversion is O(N * M)
+        int ***image = to_interleaved(planes, N, M);
+        int ***filtered = image ? apply_filter_fft(image, N, M, filter, filter_size) : NULL;
+        unsigned char *new_planes = filtered ? to_planar(filtered, N, M) : NULL;
+        free_image(image, N, M);
+        free_image(filtered, N, M);
+        return new_planes;
+    }
+
+    unsigned char *new_planes = allocate_planes(N, M);
+    if (new_planes == NULL) return NULL;
+
+    // Bands only write their rows, so every buffer is allocated up front
+    int threads = parallel_threads(3 * N, M);
+    float *acc = (float *)malloc((size_t)threads * (M > 0 ? M : 1) * sizeof(float));
+    if (acc == NULL) {
+        fprintf(stderr, "[ERROR] : Allocate filter rows...\n");
+        free(new_planes);
+        return NULL;
+    }
+
+    PlaneFilterTask ctx = {planes, new_planes, N, M, filter, filter_size, acc};
+    parallel_rows(3 * N, threads, filter_plane_rows, &ctx);
+    free(acc);
+    return new_planes;
+}
+
+typedef struct {
+    const unsigned char *planes;
+    int N, M;
+    unsigned long (*partial)[3][HISTOGRAM_BINS];  // one histogram per band
+} PlaneHistogramTask;
+
+static void histogram_plane_rows(int band, int begin, int end, void *arg) {
+    PlaneHistogramTask *ctx = (PlaneHistogramTask *)arg;
+
+    for (int r = begin; r < end; ++r) {
+        unsigned long *histogram = ctx->partial[band][r / ctx->N];
+        const unsigned char *row = ctx->planes + (size_t)r * ctx->M;
+        for (int j = 0; j < ctx->M; ++j) {
+            histogram[row[j]]++;
+        }
+    }
+}
+
+void compute_histogram_planar(const unsigned char *planes, int N, int M,
+                              unsigned long histogram[3][HISTOGRAM_BINS]) {
+    int threads = parallel_threads(3 * N, M);
+    unsigned long partial[MAX_THREADS][3][HISTOGRAM_BINS];
+    memset(partial, 0, (size_t)threads * sizeof(partial[0]));
+
+    PlaneHistogramTask ctx = {planes, N, M, partial};
+    parallel_rows(3 * N, threads, histogram_plane_rows, &ctx);
+
+    // Merge the per-band histograms
+    memset(histogram, 0, 3 * HISTOGRAM_BINS * sizeof(unsigned long));
+    for (int t = 0; t < threads; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            for (int v = 0; v < HISTOGRAM_BINS; ++v) {
+                histogram[k][v] += partial[t][k][v];
+            }
+        }
+    }
+}
+
+typedef struct {
+    unsigned char *planes;
+    int N, M;
+    unsigned char (*lut)[HISTOGRAM_BINS];
+} PlaneLutTask;
+
+static void lut_plane_rows(int band, int begin, int end, void *arg) {
+    PlaneLutTask *ctx = (PlaneLutTask *)arg;
+
+    for (int r = begin; r < end; ++r) {
+        const unsigned char *lut = ctx->lut[r / ctx->N];
+        unsigned char *row = ctx->planes + (size_t)r * ctx->M;
+        for (int j = 0; j < ctx->M; ++j) {
+            row[j] = lut[row[j]];
+        }
+    }
+}
+
+unsigned char *apply_lut_planar(unsigned char *planes, int N, int M,
+                                unsigned char lut[3][HISTOGRAM_BINS]) {
+    PlaneLutTask ctx = {planes, N, M, lut};
+    parallel_rows(3 * N, parallel_threads(3 * N, M), lut_plane_rows, &ctx);
+    return planes;
+}
+
+// Rank filters keep two-level histograms : 16 coarse bins of 16 values each
+#define RANK_COARSE 16
+#define RANK_FINE (HISTOGRAM_BINS / RANK_COARSE)
+
+// Per-band state : one histogram per column over size rows, with size / 2
+// columns of zeros padded on each side, plus the histogram of the window
+typedef struct {
+    unsigned short (*fine)[HISTOGRAM_BINS];
+    unsigned short (*coarse)[RANK_COARSE];
+    unsigned int window_fine[HISTOGRAM_BINS];
+    unsigned int window_coarse[RANK_COARSE];
+    int synced[RANK_COARSE];  // column each fine segment of the window is valid for
+} RankState;
+
+typedef struct {
+    const unsigned char *src;
+    unsigned char *dst;
+    int N, M;
+    int size, rank;
+    RankState *states;  // one per band
+} RankTask;
+
+// Helper : Column histograms of rows [i - r, i + r], rows outside count as 0
+static void rank_init_columns(RankState *state, const unsigned char *src, int N, int M, int size, int i) {
+    int r = size / 2;
+    int columns = M + 2 * r;
+    memset(state->fine, 0, (size_t)columns * sizeof(state->fine[0]));
+    memset(state->coarse, 0, (size_t)columns * sizeof(state->coarse[0]));
+
+    for (int c = 0; c < columns; ++c) {
+        if (c < r || c >= r + M) {
+            state->fine[c][0] = (unsigned short)size;
+            state->coarse[c][0] = (unsigned short)size;
+        }
+    }
+
+    for (int x = i - r; x <= i + r; ++x) {
+        const unsigned char *row = (x >= 0 && x < N) ? src + (size_t)x * M : NULL;
+        for (int j = 0; j < M; ++j) {
+            int v = row ? row[j] : 0;
+            state->fine[j + r][v]++;
+            state->coarse[j + r][v / RANK_FINE]++;
+        }
+    }
+}
+
+// Helper : Move the column histograms from row i - 1 down to row i
+static void rank_slide_columns(RankState *state, const unsigned char *src, int N, int M, int size, int i) {
+    int r = size / 2;
+    int out = i - r - 1, in = i + r;
+    const unsigned char *out_row = (out >= 0) ? src + (size_t)out * M : NULL;
+    const unsigned char *in_row = (in < N) ? src + (size_t)in * M : NULL;
+
+    for (int j = 0; j < M; ++j) {
+        int old_value = out_row ? out_row[j] : 0;
+        int new_value = in_row ? in_row[j] : 0;
+        if (old_value == new_value) continue;
+
+        state->fine[j + r][old_value]--;
+        state->fine[j + r][new_value]++;
+        state->coarse[j + r][old_value / RANK_FINE]--;
+        state->coarse[j + r][new_value / RANK_FINE]++;
+    }
+}
+
+// Helper : Bring fine segment b of the window histogram to output column j,
+// the window of column j spans padded columns [j, j + size - 1]
+static void rank_sync_segment(RankState *state, int size, int b, int j) {
+    unsigned int *window = state->window_fine + b * RANK_FINE;
+
+    if (j - state->synced[b] >= size) {
+        memset(window, 0, RANK_FINE * sizeof(unsigned int));
+        for (int c = j; c < j + size; ++c) {
+            const unsigned short *column = state->fine[c] + b * RANK_FINE;
+            for (int v = 0; v < RANK_FINE; ++v) window[v] += column[v];
+        }
+    } else {
+        for (int c = state->synced[b] + 1; c <= j; ++c) {
+            const unsigned short *added = state->fine[c + size - 1] + b * RANK_FINE;
+            const unsigned short *removed = state->fine[c - 1] + b * RANK_FINE;
+            for (int v = 0; v < RANK_FINE; ++v) window[v] += added[v] - removed[v];
+        }
+    }
+    state->synced[b] = j;
+}
+
+// Helper : Slide the window histogram along one row of output values
+static void rank_row(RankState *state, unsigned char *dst, int M, int size, int rank) {
+    memset(state->window_coarse, 0, sizeof(state->window_coarse));
+    for (int c = 0; c < size; ++c) {
+        for (int b = 0; b < RANK_COARSE; ++b) state->window_coarse[b] += state->coarse[c][b];
+    }
+    // Fine segments are only brought up to date when the rank falls in them
+    for (int b = 0; b < RANK_COARSE; ++b) state->synced[b] = -size;
+
+    for (int j = 0; j < M; ++j) {
+        if (j > 0) {
+            for (int b = 0; b < RANK_COARSE; ++b) {
+                state->window_coarse[b] += state->coarse[j + size - 1][b] - state->coarse[j - 1][b];
+            }
+        }
+
+        unsigned int count = 0;
+        int b = 0;
+        while (count + state->window_coarse[b] <= (unsigned int)rank) {
+            count += state->window_coarse[b++];
+        }
+
+        rank_sync_segment(state, size, b, j);
+        int v = b * RANK_FINE;
+        while (count + state->window_fine[v] <= (unsigned int)rank) {
+            count += state->window_fine[v++];
+        }
+        dst[j] = (unsigned char)v;
+    }
+}
+
+// Rows [begin, end) index the 3 * N rows of the R, G and B planes
+static void rank_plane_rows(int band, int begin, int end, void *arg) {
+    RankTask *ctx = (RankTask *)arg;
+    RankState *state = &ctx->states[band];
+    int N = ctx->N, M = ctx->M;
+
+    for (int r = begin; r < end; ++r) {
+        size_t plane = (size_t)(r / N) * N * M;
+        int i = r % N;
+
+        // Each band (and each plane) starts from full column histograms
+        if (r == begin || i == 0) {
+            rank_init_columns(state, ctx->src + plane, N, M, ctx->size, i);
+        } else {
+            rank_slide_columns(state, ctx->src + plane, N, M, ctx->size, i);
+        }
+        rank_row(state, ctx->dst + plane + (size_t)i * M, M, ctx->size, ctx->rank);
+    }
+}
+
+unsigned char *rank_filter_planar(const unsigned char *planes, int N, int M,
+                                  int size, int rank) {
+    unsigned char *new_planes = allocate_planes(N, M);
+    if (new_planes == NULL) return NULL;
+
+    // Bands only write their rows, so every histogram is allocated up front
+    int threads = parallel_threads(3 * N, M);
+    size_t columns = (size_t)M + size - 1;
+    RankState *states = (RankState *)malloc(threads * sizeof(RankState));
+    unsigned short (*fine)[HISTOGRAM_BINS] =
+        (unsigned short (*)[HISTOGRAM_BINS])malloc(threads * columns * sizeof(fine[0]));
+    unsigned short (*coarse)[RANK_COARSE] =
+        (unsigned short (*)[RANK_COARSE])malloc(threads * columns * sizeof(coarse[0]));
+
+    if (states == NULL || fine == NULL || coarse == NULL) {
+        fprintf(stderr, "[ERROR] : Allocate rank filter histograms...\n");
+        free(new_planes);
+        new_planes = NULL;
+    } else {
+        for (int t = 0; t < threads; ++t) {
+            states[t].fine = fine + t * columns;
+            states[t].coarse = coarse + t * columns;
+        }
+        RankTask ctx = {planes, new_planes, N, M, size, rank, states};
+        parallel_rows(3 * N, threads, rank_plane_rows, &ctx);
+    }
+
+    free(states);
+    free(fine);
+    free(coarse);
+    return new_planes;
+}
 
+int ***rank_filter(int ***image, int N, int M, int size, int rank) {
+    // Histograms need 8-bit channels, conversion is O(N * M)
+    unsigned char *planes = to_planar(image, N, M);
+    unsigned char *filtered = planes ? rank_filter_planar(planes, N, M, size, rank) : NULL;
+    int ***new_image = filtered ? to_interleaved(filtered, N, M) : NULL;
+    free(planes);
+    free(filtered);
     return new_image;
 }
 
@@ -1,19 +1,270 @@
 #include "../include/interactive.h"
 
+// Helper : Bring a planar image back to the interleaved layout
+static void make_interleaved(Image *image) {
+    if (image->planes == NULL) return;
+
+    int ***data = to_interleaved(image->planes, image->N, image->M);
+    if (data == NULL) return;
+
+    free(image->planes);
+    image->planes = NULL;
+    image->data = data;
+}
+
+// Helper : Free image data in either layout
+static void release_image(Image *image) {
+    if (image->planes != NULL) {
+        free(image->planes);
+        image->planes = NULL;
+    } else {
+        free_image(image->data, image->N, image->M);
+    }
+    image->data = NULL;
+}
+
+// Helper : Per-channel histogram of an image in either layout
+static void image_histogram(Image *image, unsigned long histogram[3][HISTOGRAM_BINS]) {
+    if (image->planes != NULL) {
+        compute_histogram_planar(image->planes, image->N, image->M, histogram);
+    } else {
+        compute_histogram(image->data, image->N, image->M, histogram);
+    }
+}
+
+// Helper : Apply lookup tables to an image in either layout
+static void image_lut(Image *image, unsigned char lut[3][HISTOGRAM_BINS]) {
+    if (image->planes != NULL) {
+        apply_lut_planar(image->planes, image->N, image->M, lut);
+    } else {
+        apply_lut(image->data, image->N, image->M, lut);
+    }
+}
+
+// Helper : Rank filter windows are odd and bounded
+static bool valid_rank_size(int size) {
+    if (size < 1 || size % 2 == 0 || size > RANK_MAX_SIZE) {
+        fprintf(stderr, "[ERROR] : Rank filter size must be odd, at most %d...\n", RANK_MAX_SIZE);
+        return false;
+    }
+    return true;
+}
+
+// Helper : Rank filter an image in either layout
+static void image_rank(Image *image, int size, int rank) {
+    if (rank < 0 || rank >= size * size) {
+        fprintf(stderr, "[ERROR] : Rank must be in [0, %d]...\n", size * size - 1);
+        return;
+    }
+
+    if (image->planes != NULL) {
+        unsigned char *new_planes = rank_filter_planar(image->planes, image->N, image->M, size, rank);
+        if (new_planes == NULL) return;
+        free(image->planes);
+        image->planes = new_planes;
+        return;
+    }
+
+    int ***new_data = rank_filter(image->data, image->N, image->M, size, rank);
+    if (new_data == NULL) return;
+    free_image(image->data, image->N, image->M);
+    image->data = new_data;
+}
+
+// Helper : A load that fails leaves an empty (0 x 0) image in its slot
+static void load_failed(const char *path, BmpStatus status) {
+    fprintf(stderr, "[ERROR] : Load BMP image %s (%s)...\n", path, bmp_strerror(status));
+}
+
+// Helper : Save an image in either layout
+static int save_image(Image *image, const char *path, BmpSync sync) {
+    if (image->planes != NULL) {
+        return write_to_bmp_planar(image->planes, image->N, image->M, path, sync);
+    }
+    return write_to_bmp(image->data, image->N, image->M, path, sync);
+}
+
+// Helper : Prints the answer to an unknown command
+static void Invalid_command(ImagesFilters *images_filters, const Command *command) {
+    fprintf(stdout, "Invalid cmd.\n");
+}
+
+static const CommandMap invalid_command = {"", "c", Invalid_command};
+
+// Helper : Scheduler resource of a file, hashed by its name (aliases collide)
+static int file_resource(const char *path) {
+    const char *name = strrchr(path, '/');
+    unsigned int hash = 5381;
+    for (name = name ? name + 1 : path; *name; ++name) {
+        hash = hash * 33 + (unsigned char)*name;
+    }
+    return RESOURCE_FILE(hash % FILE_SLOTS);
+}
+
+static void add_access(Command *command, int first, int last, bool write) {
+    if (command->access_count == MAX_ACCESSES) return;
+    Access access = {first, last, write};
+    command->accesses[command->access_count++] = access;
+}
+
+// Helper : Read the filter size and values of cf
+static bool read_filter(Command *command) {
+    int size = 0;
+    scanf("%d", &size);
+
+    // Allocate memory for filter data
+    float **data = (float **)malloc(size * sizeof(float *));
+    if (data == NULL) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return false;
+    }
+
+    for (int i = 0; i < size; ++i) {
+        data[i] = (float *)malloc(size * sizeof(float));
+        if (data[i] == NULL) {
+            fprintf(stderr, "Memory allocation failed.\n");
+            // Free previously allocated memory
+            free_filter(data, i);
+            return false;
+        }
+
+        for (int j = 0; j < size; ++j) {
+            scanf("%f", &data[i][j]);
+        }
+    }
+
+    command->filter = data;
+    command->filter_size = size;
+    return true;
+}
+
+// Helper : Read the 256 values of R, then G, then B of lu
+static bool read_lut(Command *command) {
+    command->lut = (unsigned char (*)[HISTOGRAM_BINS])malloc(3 * HISTOGRAM_BINS);
+    if (command->lut == NULL) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return false;
+    }
+
+    for (int k = 0; k < 3; ++k) {
+        for (int v = 0; v < HISTOGRAM_BINS; ++v) {
+            int value = 0;
+            scanf("%d", &value);
+            command->lut[k][v] = (unsigned char)clamp(value, 0, MAX_PIXEL_VALUE);
+        }
+    }
+    return true;
+}
+
+// Helper : Read the arguments of a command and record what it touches
+static bool parse_command(Command *command, ImagesFilters *images_filters) {
+    int *arg = command->args;
+    float *value = command->values;
+
+    for (const char *spec = command->map->args; *spec; ++spec) {
+        switch (*spec) {
+            case 'n':
+                scanf("%d", arg++);
+                break;
+            case 'v':
+                scanf("%f", value++);
+                break;
+            case 'i':
+            case 'I':
+                scanf("%d", arg);
+                add_access(command, RESOURCE_IMAGE(*arg), RESOURCE_IMAGE(*arg), *spec == 'I');
+                arg++;
+                break;
+            case 'f':
+                scanf("%d", arg);
+                add_access(command, RESOURCE_FILTER(*arg), RESOURCE_FILTER(*arg), false);
+                arg++;
+                break;
+            case 'p':
+            case 'P':
+                scanf("%99s", command->path);
+                add_access(command, file_resource(command->path), file_resource(command->path),
+                           *spec == 'P');
+                break;
+            case 'k':
+                if (!read_filter(command)) return false;
+                break;
+            case 'u':
+                if (!read_lut(command)) return false;
+                break;
+            case 'c':
+                add_access(command, RESOURCE_CONSOLE, RESOURCE_CONSOLE, true);
+                break;
+            case 'L':
+                // Loads fill the next free slot
+                *arg = images_filters->image_count++;
+                add_access(command, RESOURCE_IMAGE(*arg), RESOURCE_IMAGE(*arg), true);
+                arg++;
+                break;
+            case 'F':
+                *arg = images_filters->filter_count++;
+                add_access(command, RESOURCE_FILTER(*arg), RESOURCE_FILTER(*arg), true);
+                arg++;
+                break;
+            case 'D':
+                // Deleting shifts every later image down
+                scanf("%d", arg);
+                add_access(command, RESOURCE_IMAGE(*arg),
+                           RESOURCE_IMAGE(images_filters->image_count - 1), true);
+                *++arg = images_filters->image_count--;
+                arg++;
+                break;
+            case 'E':
+                scanf("%d", arg);
+                add_access(command, RESOURCE_FILTER(*arg),
+                           RESOURCE_FILTER(images_filters->filter_count - 1), true);
+                *++arg = images_filters->filter_count--;
+                arg++;
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+static void free_command(Command *command) {
+    free(command->lut);
+    free(command);
+}
+
+// Helper : Scheduler task running one parsed command
+static void run_command(void *arg) {
+    Command *command = (Command *)arg;
+    // Commands running on other workers share the row-band threads
+    parallel_enter();
+    command->map->func(command->images_filters, command);
+    parallel_leave();
+    free_command(command);
+}
+
 int main(void) {
     char cmd[CMD_LENGTH];
     ImagesFilters images_filters = {0};
 
+    // Time the filter paths before any worker can disturb the measurement
+    calibrate_fft_crossover();
+
+    // Independent commands run concurrently, one worker per CPU
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    scheduler_init(RESOURCE_COUNT, cpus > 0 ? (int)cpus : 1);
+
     while (true) {
-        scanf("%s", cmd);
-        if (!strcmp(cmd, "e")) break;
+        if (scanf("%9s", cmd) != 1 || !strcmp(cmd, "e")) break;
         Execute_command(cmd, &images_filters);
     }
 
+    // Finish every queued command before exiting
+    scheduler_shutdown();
+
     // Free all images and filters before exiting
     for (int i = 0; i < images_filters.image_count; ++i) {
-        free_image(images_filters.images[i].data,
-            images_filters.images[i].N, images_filters.images[i].M);
+        release_image(&images_filters.images[i]);
     }
     for (int i = 0; i < images_filters.filter_count; ++i) {
         free_filter(images_filters.filters[i].data, images_filters.filters[i].size);
@@ -23,51 +274,171 @@ int main(void) {
 }
 
 void Execute_command(const char* cmd, ImagesFilters *image_filters) {
+    const CommandMap *map = &invalid_command;
     for (int i = 0; commands[i].func != NULL; ++i) {
         if (!strcmp(commands[i].cmd, cmd)) {
-            commands[i].func(image_filters);
-            return;
+            map = &commands[i];
+            break;
         }
     }
-    fprintf(stdout, "Invalid cmd.\n");
+
+    Command *command = (Command *)calloc(1, sizeof(Command));
+    if (command == NULL) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return;
+    }
+    command->map = map;
+    command->images_filters = image_filters;
+
+    if (!parse_command(command, image_filters)) {
+        free_command(command);
+        return;
+    }
+
+    // Runs once the earlier commands touching the same images, filters,
+    // files or stdout are done
+    scheduler_submit(run_command, command, command->accesses, command->access_count);
 }
 
-void Load_image(ImagesFilters *images_filters) {
-    int N = 0, M = 0;
-    char path[PATH_LENGTH];
-    scanf("%d %d %s", &N, &M, path);
+void Load_image(ImagesFilters *images_filters, const Command *command) {
+    int N = command->args[0], M = command->args[1], slot = command->args[2];
+    const char *path = command->path;
+
+    // Validate the file before allocating memory for the image
+    int ***image_data = NULL;
+    FILE *file = NULL;
+    BmpInfo info;
+    BmpStatus status = bmp_open(path, N, M, &file, &info);
+    if (status == BMP_OK) {
+        image_data = allocate_image(N, M);
+        // Load image data from the same open file
+        status = image_data ? read_from_bmp_stream(file, &info, image_data, N, M) : BMP_ERR_MEMORY;
+        fclose(file);
+    }
+
+    if (status != BMP_OK) {
+        load_failed(path, status);
+        free_image(image_data, N, M);
+        image_data = NULL;
+        N = M = 0;
+    }
+    // Assign new data to the image
+    images_filters->images[slot].data = image_data;
+    images_filters->images[slot].planes = NULL;
+    images_filters->images[slot].N = N;
+    images_filters->images[slot].M = M;
+}
 
-    // Allocate memory for the image
-    int ***image_data = (int ***)malloc(N * sizeof(int **));
-    for (int i = 0; i < N; i++) {
-        image_data[i] = (int **)malloc(M * sizeof(int *));
-        for (int j = 0; j < M; j++) {
-            image_data[i][j] = (int *)malloc(3 * sizeof(int));
+void Load_image_crop(ImagesFilters *images_filters, const Command *command) {
+    int N = command->args[0], M = command->args[1], x = command->args[2], y = command->args[3];
+    int w = command->args[4], h = command->args[5], slot = command->args[6];
+    const char *path = command->path;
+
+    // Validate the file, then allocate memory only for the cropped region
+    int ***image_data = NULL;
+    FILE *file = NULL;
+    BmpInfo info;
+    BmpStatus status = bmp_open(path, N, M, &file, &info);
+    if (status == BMP_OK) {
+        status = bmp_check_size(h, w);
+        image_data = status == BMP_OK ? allocate_image(h, w) : NULL;
+        // Seek to the needed rows and read only the window bytes
+        if (status == BMP_OK) {
+            status = image_data ? read_from_bmp_window_stream(file, &info, image_data, N, M, x, y, h, w)
+                                : BMP_ERR_MEMORY;
         }
+        fclose(file);
     }
 
-    // Load image data from BMP file
-    read_from_bmp(image_data, N, M, path);
+    if (status != BMP_OK) {
+        load_failed(path, status);
+        free_image(image_data, h, w);
+        image_data = NULL;
+        h = w = 0;
+    }
     // Assign new data to the image
-    images_filters->images[images_filters->image_count].data = image_data;
-    images_filters->images[images_filters->image_count].N = N;
-    images_filters->images[images_filters->image_count].M = M;
-    images_filters->image_count++;
+    images_filters->images[slot].data = image_data;
+    images_filters->images[slot].planes = NULL;
+    images_filters->images[slot].N = h;
+    images_filters->images[slot].M = w;
 }
 
-void Save_image(ImagesFilters *images_filters) {
-    int index = 0;
-    char path[PATH_LENGTH];
-    scanf("%d %s", &index, path);
+void Save_image(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0];
+    const char *path = command->path;
 
     // Save image data to BMP file
-    write_to_bmp(images_filters->images[index].data,
-        images_filters->images[index].N, images_filters->images[index].M, path);
+    if (save_image(&images_filters->images[index], path, BMP_SYNC_NONE) != 0) {
+        fprintf(stderr, "[ERROR] : Save BMP image...\n");
+    }
+}
+
+void Save_image_sync(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0];
+    const char *path = command->path;
+
+    // Save image data to BMP file and wait until it reaches the disk
+    if (save_image(&images_filters->images[index], path, BMP_SYNC_DATA) != 0) {
+        fprintf(stderr, "[ERROR] : Save BMP image...\n");
+    }
+}
+
+void Load_image_planar(ImagesFilters *images_filters, const Command *command) {
+    int N = command->args[0], M = command->args[1], slot = command->args[2];
+    const char *path = command->path;
+
+    // Validate the file, then allocate one block holding the R, G and B planes
+    unsigned char *planes = NULL;
+    FILE *file = NULL;
+    BmpInfo info;
+    BmpStatus status = bmp_open(path, N, M, &file, &info);
+    if (status == BMP_OK) {
+        planes = allocate_planes(N, M);
+        // Load image data from the same open file, deinterleaving each row
+        status = planes ? read_from_bmp_planar_stream(file, &info, planes, N, M) : BMP_ERR_MEMORY;
+        fclose(file);
+    }
+
+    if (status != BMP_OK) {
+        load_failed(path, status);
+        free(planes);
+        planes = NULL;
+        N = M = 0;
+    }
+    // Assign new data to the image
+    images_filters->images[slot].data = NULL;
+    images_filters->images[slot].planes = planes;
+    images_filters->images[slot].N = N;
+    images_filters->images[slot].M = M;
+}
+
+void Convert_planar(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0];
+
+    if (images_filters->images[index].planes != NULL) return;
+
+    unsigned char *planes = to_planar(images_filters->images[index].data,
+                        images_filters->images[index].N, images_filters->images[index].M);
+    if (planes == NULL) return;
+
+    // Free the memory of the interleaved image data
+    free_image(images_filters->images[index].data,
+        images_filters->images[index].N, images_filters->images[index].M);
+
+    // Update data
+    images_filters->images[index].data = NULL;
+    images_filters->images[index].planes = planes;
 }
 
-void Apply_horizontal_flip(ImagesFilters *images_filters) {
-    int index = 0;
-    scanf("%d", &index);
+void Convert_interleaved(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0];
+
+    make_interleaved(&images_filters->images[index]);
+}
+
+void Apply_horizontal_flip(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0];
+    make_interleaved(&images_filters->images[index]);
 
     int ***new_data = flip_horizontal(images_filters->images[index].data,
                         images_filters->images[index].N, images_filters->images[index].M);
@@ -80,9 +451,9 @@ void Apply_horizontal_flip(ImagesFilters *images_filters) {
     images_filters->images[index].data = new_data;
 }
 
-void Apply_rotate(ImagesFilters *images_filters) {
-    int index = 0;
-    scanf("%d", &index);
+void Apply_rotate(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0];
+    make_interleaved(&images_filters->images[index]);
 
     int ***new_data = rotate_left(images_filters->images[index].data,
                         images_filters->images[index].N, images_filters->images[index].M);
@@ -98,9 +469,10 @@ void Apply_rotate(ImagesFilters *images_filters) {
     images_filters->images[index].M = temp;
 }
 
-void Apply_crop(ImagesFilters *images_filters) {
-    int index = 0, x = 0, y = 0, h = 0, w = 0;
-    scanf("%d %d %d %d %d", &index, &x, &y, &w, &h);
+void Apply_crop(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0], x = command->args[1], y = command->args[2];
+    int w = command->args[3], h = command->args[4];
+    make_interleaved(&images_filters->images[index]);
 
     int ***new_data = crop(images_filters->images[index].data,
                 images_filters->images[index].N, images_filters->images[index].M, x, y, h, w);
@@ -115,9 +487,10 @@ void Apply_crop(ImagesFilters *images_filters) {
     images_filters->images[index].M = w;
 }
 
-void Apply_extend(ImagesFilters *images_filters) {
-    int index = 0, rows = 0, cols = 0, new_R = 0, new_G = 0, new_B = 0;
-    scanf("%d %d %d %d %d %d", &index, &rows, &cols, &new_R, &new_G, &new_B);
+void Apply_extend(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0], rows = command->args[1], cols = command->args[2];
+    int new_R = command->args[3], new_G = command->args[4], new_B = command->args[5];
+    make_interleaved(&images_filters->images[index]);
 
     // Get the dimensions of the existing image
     int old_N = images_filters->images[index].N;
@@ -139,9 +512,11 @@ void Apply_extend(ImagesFilters *images_filters) {
     images_filters->images[index].M = new_M;
 }
 
-void Apply_paste(ImagesFilters *images_filters) {
-    int index_dst = 0, index_src = 0, x = 0, y = 0;
-    scanf("%d %d %d %d", &index_dst, &index_src, &x, &y);
+void Apply_paste(ImagesFilters *images_filters, const Command *command) {
+    int index_dst = command->args[0], index_src = command->args[1];
+    int x = command->args[2], y = command->args[3];
+    make_interleaved(&images_filters->images[index_dst]);
+    make_interleaved(&images_filters->images[index_src]);
 
     paste(images_filters->images[index_dst].data,
         images_filters->images[index_dst].N, images_filters->images[index_dst].M,
@@ -149,41 +524,28 @@ void Apply_paste(ImagesFilters *images_filters) {
         images_filters-> images[index_src].N, images_filters->images[index_src].M, x, y);
 }
 
-void Create_filter(ImagesFilters *images_filters) {
-    int size = 0;
-    scanf("%d", &size);
+void Create_filter(ImagesFilters *images_filters, const Command *command) {
+    int slot = command->args[0];
 
-    // Allocate memory for filter data
-    images_filters->filters[images_filters->filter_count].data = (float **)malloc(size * sizeof(float *));
-    if (images_filters->filters[images_filters->filter_count].data == NULL) {
-        fprintf(stderr, "Memory allocation failed.\n");
-        return;
-    }
+    // Filter data was read (and allocated) with the command
+    images_filters->filters[slot].data = command->filter;
+    images_filters->filters[slot].size = command->filter_size;
+}
 
-    for (int i = 0; i < size; ++i) {
-        images_filters->filters[images_filters->filter_count].data[i] = (float *)malloc(size * sizeof(float));
-        if (images_filters->filters[images_filters->filter_count].data[i] == NULL) {
-            fprintf(stderr, "Memory allocation failed.\n");
-            // Free previously allocated memory
-            for (int j = 0; j < i; ++j) {
-                free(images_filters->filters[images_filters->filter_count].data[j]);
-            }
-            free(images_filters->filters[images_filters->filter_count].data);
-            return;
-        }
+void Apply_Filter(ImagesFilters *images_filters, const Command *command)  {
+    int index_img = command->args[0], index_filter = command->args[1];
 
-        for (int j = 0; j < size; ++j) {
-            scanf("%f", &images_filters->filters[images_filters->filter_count].data[i][j]);
-        }
-    }
-
-    images_filters->filters[images_filters->filter_count].size = size;
-    images_filters->filter_count++;
-}
+    // Planar images are filtered one channel plane at a time
+    if (images_filters->images[index_img].planes != NULL) {
+        unsigned char *new_planes = apply_filter_planar(images_filters->images[index_img].planes,
+            images_filters->images[index_img].N, images_filters->images[index_img].M,
+            images_filters->filters[index_filter].data, images_filters->filters[index_filter].size);
+        if (new_planes == NULL) return;
 
-void Apply_Filter(ImagesFilters *images_filters)  {
-    int index_img = 0, index_filter = 0;
-    scanf("%d %d", &index_img, &index_filter);
+        free(images_filters->images[index_img].planes);
+        images_filters->images[index_img].planes = new_planes;
+        return;
+    }
 
     int ***new_data = apply_filter(images_filters->images[index_img].data,
         images_filters->images[index_img].N, images_filters->images[index_img].M,
@@ -197,32 +559,123 @@ void Apply_Filter(ImagesFilters *images_filters)  {
     images_filters->images[index_img].data = new_data;
 }
 
-void Delete_filter(ImagesFilters *images_filters) {
-    int index_filter = 0;
-    scanf("%d", &index_filter);
+void Print_histogram(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0];
+
+    unsigned long histogram[3][HISTOGRAM_BINS];
+    image_histogram(&images_filters->images[index], histogram);
+
+    // One line per channel : R, G, B
+    const char channels[3] = {'R', 'G', 'B'};
+    for (int k = 0; k < 3; ++k) {
+        fprintf(stdout, "%c", channels[k]);
+        for (int v = 0; v < HISTOGRAM_BINS; ++v) {
+            fprintf(stdout, " %lu", histogram[k][v]);
+        }
+        fprintf(stdout, "\n");
+    }
+}
+
+void Print_stats(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0];
+
+    unsigned long histogram[3][HISTOGRAM_BINS];
+    ChannelStats stats[3];
+    image_histogram(&images_filters->images[index], histogram);
+    compute_stats(histogram, stats);
+
+    // One line per channel : R, G, B
+    const char channels[3] = {'R', 'G', 'B'};
+    for (int k = 0; k < 3; ++k) {
+        fprintf(stdout, "%c %d %d %.2f\n", channels[k], stats[k].min, stats[k].max, stats[k].mean);
+    }
+}
+
+void Apply_lut(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0];
+
+    // Tables were read with the command
+    image_lut(&images_filters->images[index], command->lut);
+}
+
+void Apply_gamma(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0];
+    float gamma = command->values[0];
+
+    if (gamma <= 0) {
+        fprintf(stderr, "[ERROR] : Gamma must be positive...\n");
+        return;
+    }
+
+    unsigned char lut[3][HISTOGRAM_BINS];
+    gamma_lut(gamma, lut);
+    image_lut(&images_filters->images[index], lut);
+}
+
+void Apply_levels(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0], low = command->args[1], high = command->args[2];
+
+    unsigned char lut[3][HISTOGRAM_BINS];
+    levels_lut(low, high, lut);
+    image_lut(&images_filters->images[index], lut);
+}
+
+void Apply_autocontrast(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0];
+
+    // Stretch range comes from the histogram of the image itself
+    unsigned long histogram[3][HISTOGRAM_BINS];
+    unsigned char lut[3][HISTOGRAM_BINS];
+    image_histogram(&images_filters->images[index], histogram);
+    autocontrast_lut(histogram, lut);
+    image_lut(&images_filters->images[index], lut);
+}
+
+void Apply_median(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0], size = command->args[1];
+    if (!valid_rank_size(size)) return;
+    image_rank(&images_filters->images[index], size, size * size / 2);
+}
+
+void Apply_min(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0], size = command->args[1];
+    if (!valid_rank_size(size)) return;
+    image_rank(&images_filters->images[index], size, 0);
+}
+
+void Apply_max(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0], size = command->args[1];
+    if (!valid_rank_size(size)) return;
+    image_rank(&images_filters->images[index], size, size * size - 1);
+}
+
+void Apply_rank(ImagesFilters *images_filters, const Command *command) {
+    int index = command->args[0], size = command->args[1], rank = command->args[2];
+    if (!valid_rank_size(size)) return;
+    image_rank(&images_filters->images[index], size, rank);
+}
+
+void Delete_filter(ImagesFilters *images_filters, const Command *command) {
+    int index_filter = command->args[0], filter_count = command->args[1];
 
     // Free the filter data at specified index only if it's not in use
     free_filter(images_filters->filters[index_filter].data,
             images_filters->filters[index_filter].size);
 
     // Shift remaining filters to fill the gap
-    for (int i = index_filter; i < images_filters->filter_count - 1; ++i) {
+    for (int i = index_filter; i < filter_count - 1; ++i) {
        images_filters->filters[i] = images_filters->filters[i + 1];
     }
-    images_filters->filter_count--;
 }
 
-void Delete_Image(ImagesFilters *images_filters) {
-    int index_img = 0;
-    scanf("%d", &index_img);
+void Delete_Image(ImagesFilters *images_filters, const Command *command) {
+    int index_img = command->args[0], image_count = command->args[1];
 
     // Free the image data at specified index only if it's not in use
-    free_image(images_filters->images[index_img].data,
-            images_filters->images[index_img].N, images_filters->images[index_img].M);
+    release_image(&images_filters->images[index_img]);
 
     // Shift remaining images to fill the gap
-    for (int i = index_img; i < images_filters->image_count - 1; ++i) {
+    for (int i = index_img; i < image_count - 1; ++i) {
         images_filters->images[i] = images_filters->images[i + 1];
     }
-    images_filters->image_count--;
 }
@@ -0,0 +1,228 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../include/scheduler.h"
+
+typedef struct TTask {
+    TaskFunc func;
+    void *arg;
+    int pending;                // unfinished tasks this one waits for
+    bool done;
+    struct TTask **dependents;  // tasks waiting for this one
+    int dependent_count, dependent_capacity;
+    struct TTask *next_ready;   // ready queue link
+    struct TTask *next_task;    // list of all tasks, freed when idle
+} Task;
+
+// Tasks that last touched a resource
+typedef struct TResource {
+    Task *writer;               // last task writing it
+    Task **readers;             // tasks reading it since that write
+    int reader_count, reader_capacity;
+} Resource;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t ready_cond;  // a task became ready (or stopping)
+    pthread_cond_t idle_cond;   // a task finished
+    pthread_t workers[MAX_WORKERS];
+    int worker_count;
+    Resource *resources;
+    int resource_count;
+    Task *ready_head, *ready_tail;
+    Task *tasks;
+    int outstanding;            // submitted but not finished
+    bool stop;
+} scheduler;
+
+// Helper : Grow an array of task pointers (2x), false on failure
+static bool push_task(Task ***array, int *count, int *capacity, Task *task) {
+    if (*count == *capacity) {
+        int new_capacity = *capacity ? 2 * *capacity : 4;
+        Task **grown = (Task **)realloc(*array, new_capacity * sizeof(Task *));
+        if (grown == NULL) return false;
+        *array = grown;
+        *capacity = new_capacity;
+    }
+    (*array)[(*count)++] = task;
+    return true;
+}
+
+static void enqueue_ready(Task *task) {
+    task->next_ready = NULL;
+    if (scheduler.ready_tail) {
+        scheduler.ready_tail->next_ready = task;
+    } else {
+        scheduler.ready_head = task;
+    }
+    scheduler.ready_tail = task;
+    pthread_cond_signal(&scheduler.ready_cond);
+}
+
+// Helper : Make task wait for before (if it has not finished yet)
+static bool add_dependency(Task *task, Task *before) {
+    if (before == NULL || before == task || before->done) return true;
+    // Several shared resources give the same edge, keep it once
+    if (before->dependent_count > 0 &&
+        before->dependents[before->dependent_count - 1] == task) return true;
+
+    if (!push_task(&before->dependents, &before->dependent_count,
+                   &before->dependent_capacity, task)) return false;
+    task->pending++;
+    return true;
+}
+
+// Helper : Free finished tasks once nothing is left in flight
+static void reclaim_tasks(void) {
+    while (scheduler.tasks) {
+        Task *next = scheduler.tasks->next_task;
+        free(scheduler.tasks->dependents);
+        free(scheduler.tasks);
+        scheduler.tasks = next;
+    }
+    for (int r = 0; r < scheduler.resource_count; ++r) {
+        scheduler.resources[r].writer = NULL;
+        scheduler.resources[r].reader_count = 0;
+    }
+}
+
+static void *worker_loop(void *arg) {
+    pthread_mutex_lock(&scheduler.lock);
+    while (true) {
+        while (scheduler.ready_head == NULL && !scheduler.stop) {
+            pthread_cond_wait(&scheduler.ready_cond, &scheduler.lock);
+        }
+        if (scheduler.ready_head == NULL) break;
+
+        Task *task = scheduler.ready_head;
+        scheduler.ready_head = task->next_ready;
+        if (scheduler.ready_head == NULL) scheduler.ready_tail = NULL;
+
+        pthread_mutex_unlock(&scheduler.lock);
+        task->func(task->arg);
+        pthread_mutex_lock(&scheduler.lock);
+
+        // Release the tasks waiting for this one
+        task->done = true;
+        for (int i = 0; i < task->dependent_count; ++i) {
+            if (--task->dependents[i]->pending == 0) enqueue_ready(task->dependents[i]);
+        }
+        scheduler.outstanding--;
+        pthread_cond_broadcast(&scheduler.idle_cond);
+    }
+    pthread_mutex_unlock(&scheduler.lock);
+    return NULL;
+}
+
+void scheduler_init(int resources, int workers) {
+    pthread_mutex_init(&scheduler.lock, NULL);
+    pthread_cond_init(&scheduler.ready_cond, NULL);
+    pthread_cond_init(&scheduler.idle_cond, NULL);
+    scheduler.resources = (Resource *)calloc(resources, sizeof(Resource));
+    scheduler.resource_count = scheduler.resources ? resources : 0;
+    scheduler.ready_head = scheduler.ready_tail = NULL;
+    scheduler.tasks = NULL;
+    scheduler.outstanding = 0;
+    scheduler.stop = false;
+
+    if (workers > MAX_WORKERS) workers = MAX_WORKERS;
+    scheduler.worker_count = 0;
+    for (int i = 0; i < workers; ++i) {
+        if (pthread_create(&scheduler.workers[i], NULL, worker_loop, NULL) != 0) break;
+        scheduler.worker_count++;
+    }
+    if (scheduler.resources == NULL || scheduler.worker_count == 0) {
+        fprintf(stderr, "[ERROR] : Start scheduler, running commands in order...\n");
+    }
+}
+
+void scheduler_submit(TaskFunc func, void *arg, const Access *accesses, int count) {
+    pthread_mutex_lock(&scheduler.lock);
+    if (scheduler.outstanding == 0) reclaim_tasks();
+
+    Task *task = (Task *)calloc(1, sizeof(Task));
+    if (task == NULL || scheduler.resources == NULL || scheduler.worker_count == 0) {
+        // No way to track it : run in order after everything else
+        while (scheduler.outstanding > 0) {
+            pthread_cond_wait(&scheduler.idle_cond, &scheduler.lock);
+        }
+        pthread_mutex_unlock(&scheduler.lock);
+        free(task);
+        func(arg);
+        return;
+    }
+
+    task->func = func;
+    task->arg = arg;
+    task->pending = 1;  // held until all dependencies are recorded
+    task->next_task = scheduler.tasks;
+    scheduler.tasks = task;
+    scheduler.outstanding++;
+
+    bool tracked = true;
+    for (int a = 0; a < count; ++a) {
+        for (int r = accesses[a].first; r <= accesses[a].last; ++r) {
+            if (r < 0 || r >= scheduler.resource_count) continue;
+            Resource *resource = &scheduler.resources[r];
+
+            // Readers wait for the last writer, writers also for later readers
+            tracked &= add_dependency(task, resource->writer);
+            if (accesses[a].write) {
+                for (int i = 0; i < resource->reader_count; ++i) {
+                    tracked &= add_dependency(task, resource->readers[i]);
+                }
+                resource->writer = task;
+                resource->reader_count = 0;
+            } else {
+                tracked &= push_task(&resource->readers, &resource->reader_count,
+                                     &resource->reader_capacity, task);
+            }
+        }
+    }
+
+    if (!tracked) {
+        // Out of memory : run it alone, once everything before it is done
+        fprintf(stderr, "[ERROR] : Track command dependencies...\n");
+        while (scheduler.outstanding > 1) {
+            pthread_cond_wait(&scheduler.idle_cond, &scheduler.lock);
+        }
+    }
+
+    if (--task->pending == 0) enqueue_ready(task);
+    while (!tracked && scheduler.outstanding > 0) {
+        pthread_cond_wait(&scheduler.idle_cond, &scheduler.lock);
+    }
+    pthread_mutex_unlock(&scheduler.lock);
+}
+
+void scheduler_wait(void) {
+    pthread_mutex_lock(&scheduler.lock);
+    while (scheduler.outstanding > 0) {
+        pthread_cond_wait(&scheduler.idle_cond, &scheduler.lock);
+    }
+    pthread_mutex_unlock(&scheduler.lock);
+}
+
+void scheduler_shutdown(void) {
+    scheduler_wait();
+
+    pthread_mutex_lock(&scheduler.lock);
+    scheduler.stop = true;
+    pthread_cond_broadcast(&scheduler.ready_cond);
+    pthread_mutex_unlock(&scheduler.lock);
+
+    for (int i = 0; i < scheduler.worker_count; ++i) {
+        pthread_join(scheduler.workers[i], NULL);
+    }
+
+    reclaim_tasks();
+    for (int r = 0; r < scheduler.resource_count; ++r) {
+        free(scheduler.resources[r].readers);
+    }
+    free(scheduler.resources);
+    scheduler.resources = NULL;
+    pthread_cond_destroy(&scheduler.ready_cond);
+    pthread_cond_destroy(&scheduler.idle_cond);
+    pthread_mutex_destroy(&scheduler.lock);
+}
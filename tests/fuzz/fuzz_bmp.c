@@ -0,0 +1,99 @@
+/*
+ * libFuzzer harness for the BMP decoder.
+ *
+ * Build and run from build/ with `make fuzz` (clang), or replay the corpus
+ * without libFuzzer with `make fuzz-replay` (FUZZ_STANDALONE main below).
+ */
+#define _GNU_SOURCE
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../include/bmp.h"
+#include "../../include/imageprocessing.h"
+
+// Keep single inputs fast : larger images are only header-checked
+#define FUZZ_MAX_PIXELS (1 << 20)
+
+// The last input bytes choose the extra rows and the lc window
+#define FUZZ_PARAM_BYTES 9
+#define FUZZ_MARGIN 16  // windows may start this far outside the image
+
+// Helper : Parameter k (8 or 16 bit), 0 when the input is too short
+static int fuzz_param(const uint8_t *data, size_t size, int k, int bytes) {
+    if (size < FUZZ_PARAM_BYTES) return 0;
+    const uint8_t *tail = data + size - FUZZ_PARAM_BYTES + k;
+    return bytes == 2 ? tail[0] | (tail[1] << 8) : tail[0];
+}
+
+// Helper : Decode with every reader that lc, l and lp use
+static void fuzz_readers(FILE *file, const BmpInfo *info, const uint8_t *data, size_t size) {
+    // Also decode a few rows past the stored height (repeated pixel)
+    int N = info->height + fuzz_param(data, size, 0, 1) % 4;
+    int M = info->width;
+    if (bmp_check_size(N, M) != BMP_OK || (long)N * M > FUZZ_MAX_PIXELS) return;
+
+    int ***image = allocate_image(N, M);
+    if (image != NULL) {
+        read_from_bmp_stream(file, info, image, N, M);
+        free_image(image, N, M);
+    }
+
+    unsigned char *planes = allocate_planes(N, M);
+    if (planes != NULL) {
+        read_from_bmp_planar_stream(file, info, planes, N, M);
+        free(planes);
+    }
+
+    // A window of the image, possibly partly (or wholly) outside it
+    int x = fuzz_param(data, size, 1, 2) % (M + 2 * FUZZ_MARGIN) - FUZZ_MARGIN;
+    int y = fuzz_param(data, size, 3, 2) % (N + 2 * FUZZ_MARGIN) - FUZZ_MARGIN;
+    int w = 1 + fuzz_param(data, size, 5, 2) % (M + FUZZ_MARGIN);
+    int h = 1 + fuzz_param(data, size, 7, 2) % (N + FUZZ_MARGIN);
+    if ((long)h * w > FUZZ_MAX_PIXELS) return;
+
+    int ***window = allocate_image(h, w);
+    if (window != NULL) {
+        read_from_bmp_window_stream(file, info, window, N, M, x, y, h, w);
+        free_image(window, h, w);
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size == 0) return 0;
+
+    FILE *file = fmemopen((void *)data, size, "rb");
+    if (file == NULL) return 0;
+
+    BmpInfo info;
+    if (bmp_read_info(file, &info) == BMP_OK) {
+        fuzz_readers(file, &info, data, size);
+    }
+
+    fclose(file);
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+// Run every file given on the command line once
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+        FILE *file = fopen(argv[i], "rb");
+        if (file == NULL) continue;
+
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        uint8_t *data = (uint8_t *)malloc(size > 0 ? size : 1);
+        if (data != NULL && fread(data, 1, size, file) == (size_t)size) {
+            LLVMFuzzerTestOneInput(data, size);
+        }
+        free(data);
+        fclose(file);
+    }
+    return 0;
+}
+#endif